@@ -0,0 +1,143 @@
+/**
+ * @file arena.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "arena.h"
+#include <assert.h>
+
+#define MEM_ARENA_BLOCK_SIZE (64 * 1024)
+#define MEM_ARENA_CHUNK_SIZE 4096
+
+// Requests bigger than this get a block of their own.
+#define MEM_ARENA_BIG_SIZE(ARENA) ((ARENA)->block_size / 4)
+
+// Called with the arena mutex held.
+static mem_arena_block_t *mem_arena_create_block(mem_arena_t *arena, size_t len) {
+  mem_arena_block_t *block;
+
+  block = mem_heap_alloc_aligned(arena->heap, sizeof(mem_arena_block_t) + len, CACHE_LINE_SIZE);
+  block->free = 0;
+  block->len = len;
+  block->data = (byte *)(block + 1);
+
+  return block;
+}
+
+mem_arena_t *mem_arena_create(size_t block_size) {
+  mem_heap_t *heap;
+  mem_arena_t *arena;
+
+  if (!block_size) {
+    block_size = MEM_ARENA_BLOCK_SIZE;
+  }
+
+  block_size = MEM_SPACE_NEEDED(block_size);
+
+  heap = mem_heap_create(sizeof(mem_arena_t) + sizeof(mem_arena_block_t) + block_size + CACHE_LINE_SIZE);
+
+  arena = mem_heap_alloc(heap, sizeof(mem_arena_t));
+  mutex_init(&arena->mutex);
+  arena->heap = heap;
+  arena->block_size = block_size;
+  arena->block = mem_arena_create_block(arena, block_size);
+
+  return arena;
+}
+
+void mem_arena_free(mem_arena_t *arena) {
+  assert(arena);
+
+  mutex_destroy(&arena->mutex);
+  mem_heap_free(arena->heap);
+}
+
+static void *mem_arena_alloc_big(mem_arena_t *arena, size_t n) {
+  void *buf;
+
+  mutex_lock(&arena->mutex);
+  buf = mem_heap_alloc(arena->heap, n);
+  mutex_unlock(&arena->mutex);
+
+  return buf;
+}
+
+// Replaces full, unless another thread has already done so.
+static void mem_arena_refill(mem_arena_t *arena, mem_arena_block_t *full) {
+  mutex_lock(&arena->mutex);
+
+  if (__atomic_load_n(&arena->block, __ATOMIC_RELAXED) == full) {
+    __atomic_store_n(&arena->block, mem_arena_create_block(arena, arena->block_size), __ATOMIC_RELEASE);
+  }
+
+  mutex_unlock(&arena->mutex);
+}
+
+void *mem_arena_alloc(mem_arena_t *arena, size_t n) {
+  mem_arena_block_t *block;
+  size_t offset;
+
+  assert(arena);
+
+  n = MEM_SPACE_NEEDED(n);
+
+  if (n > MEM_ARENA_BIG_SIZE(arena)) {
+    return mem_arena_alloc_big(arena, n);
+  }
+
+  for (;;) {
+    block = __atomic_load_n(&arena->block, __ATOMIC_ACQUIRE);
+
+    offset = __atomic_fetch_add(&block->free, n, __ATOMIC_RELAXED);
+
+    if (offset + n <= block->len) {
+      return block->data + offset;
+    }
+
+    mem_arena_refill(arena, block);
+  }
+}
+
+size_t mem_arena_get_size(mem_arena_t *arena) {
+  size_t size;
+
+  assert(arena);
+
+  mutex_lock(&arena->mutex);
+  size = mem_heap_get_size(arena->heap);
+  mutex_unlock(&arena->mutex);
+
+  return size;
+}
+
+void mem_arena_local_init(mem_arena_local_t *local, mem_arena_t *arena, size_t chunk_size) {
+  assert(local);
+  assert(arena);
+
+  if (!chunk_size) {
+    chunk_size = MEM_ARENA_CHUNK_SIZE;
+  }
+
+  local->arena = arena;
+  local->free = NULL;
+  local->end = NULL;
+  local->chunk_size = min(MEM_SPACE_NEEDED(chunk_size), MEM_ARENA_BIG_SIZE(arena));
+}
+
+void *mem_arena_local_refill(mem_arena_local_t *local, size_t n) {
+  byte *buf;
+
+  assert(n == MEM_SPACE_NEEDED(n));
+
+  // A request that does not fit a chunk goes to the arena without dropping the chunk.
+  if (n > local->chunk_size / 2) {
+    return mem_arena_alloc(local->arena, n);
+  }
+
+  buf = mem_arena_alloc(local->arena, local->chunk_size);
+
+  local->free = buf + n;
+  local->end = buf + local->chunk_size;
+
+  return buf;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file arena.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef ARENA_H
+#define ARENA_H
+#include "calc.h"
+#include "heap.h"
+#include "mutex.h"
+
+/* A heap that many threads allocate from at once. Threads bump the free offset
+of the current block with an atomic fetch-add, a thread that overshoots the
+block installs a new one under the mutex. Like mem_heap_t, memory is only
+given back when the whole arena is freed. */
+typedef struct mem_arena_block_t mem_arena_block_t;
+struct mem_arena_block_t {
+    size_t free;
+    size_t len;
+    byte *data;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+typedef struct mem_arena_t mem_arena_t;
+struct mem_arena_t {
+    mutex_t mutex;
+    mem_heap_t *heap;
+    mem_arena_block_t *block;
+    size_t block_size;
+};
+
+/* A chunk of an arena reserved by one thread, allocations from it take no
+atomic operations. Unused space in the chunk is lost when it is refilled. */
+typedef struct mem_arena_local_t mem_arena_local_t;
+struct mem_arena_local_t {
+    mem_arena_t *arena;
+    byte *free;
+    byte *end;
+    size_t chunk_size;
+};
+
+// block_size of 0 picks a default.
+mem_arena_t *mem_arena_create(size_t block_size);
+
+void mem_arena_free(mem_arena_t *arena);
+
+void *mem_arena_alloc(mem_arena_t *arena, size_t n);
+
+size_t mem_arena_get_size(mem_arena_t *arena);
+
+// chunk_size of 0 picks a default.
+void mem_arena_local_init(mem_arena_local_t *local, mem_arena_t *arena, size_t chunk_size);
+
+void *mem_arena_local_refill(mem_arena_local_t *local, size_t n);
+
+static inline void *mem_arena_local_alloc(mem_arena_local_t *local, size_t n) {
+  byte *buf;
+
+  n = MEM_SPACE_NEEDED(n);
+
+  if ((size_t)(local->end - local->free) < n) {
+    return mem_arena_local_refill(local, n);
+  }
+
+  buf = local->free;
+  local->free += n;
+
+  return buf;
+}
+
+#endif
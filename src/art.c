@@ -0,0 +1,863 @@
+/**
+ * @file art.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "art.h"
+#include "calc.h"
+#include <assert.h>
+#include <string.h>
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
+#define ART_HEAP_SIZE 4096
+
+#define ART_IS_LEAF(P) ((uintptr_t)(P) & 1)
+#define ART_TAG(LEAF) ((void *)((uintptr_t)(LEAF) | 1))
+#define ART_UNTAG(P) ((art_leaf_t *)((uintptr_t)(P) & ~(uintptr_t)1))
+
+static const size_t art_node_sizes[4] = {sizeof(art_node4_t), sizeof(art_node16_t), sizeof(art_node48_t),
+                                         sizeof(art_node256_t)};
+
+typedef struct art_range_t art_range_t;
+struct art_range_t {
+    art_callback_t callback;
+    void *arg;
+    const byte *hi;
+    size_t hi_len;
+    bool done;
+};
+
+static int art_key_compare(const byte *a, size_t a_len, const byte *b, size_t b_len) {
+  int cmp = memcmp(a, b, min(a_len, b_len));
+
+  if (cmp != 0) {
+    return cmp;
+  }
+
+  return (a_len > b_len) - (a_len < b_len);
+}
+
+static bool art_leaf_matches(const art_leaf_t *leaf, const byte *key, size_t len) {
+  return leaf->key_len == len && memcmp(leaf->key, key, len) == 0;
+}
+
+// Stores the bytes a leaf of a class takes, any key of the class fits them.
+static size_t art_leaf_class(size_t len, size_t *size) {
+  size_t n = MEM_SPACE_NEEDED(sizeof(art_leaf_t) + len);
+
+  if (n <= ART_LEAF_STEP_MAX) {
+    *size = n;
+    return n / MEM_ALIGNMENT - 1;
+  }
+
+  *size = calc_2_power_up(n);
+  return ART_LEAF_STEP_MAX / MEM_ALIGNMENT + calc_2_log(n) - calc_2_log(ART_LEAF_STEP_MAX) - 1;
+}
+
+static art_leaf_t *art_leaf_create(art_t *tree, const byte *key, size_t len, void *value) {
+  art_leaf_t *leaf;
+  size_t size;
+  size_t c;
+
+  assert(len <= UINT32_MAX);
+
+  c = art_leaf_class(len, &size);
+  leaf = tree->free_leaves[c];
+
+  if (leaf != NULL) {
+    tree->free_leaves[c] = *(art_leaf_t **)leaf;
+  } else {
+    leaf = mem_heap_alloc(tree->heap, size);
+  }
+
+  leaf->value = value;
+  leaf->key_len = (uint32_t)len;
+  memcpy(leaf->key, key, len);
+
+  return leaf;
+}
+
+static void art_leaf_release(art_t *tree, art_leaf_t *leaf) {
+  size_t size;
+  size_t c = art_leaf_class(leaf->key_len, &size);
+
+  *(art_leaf_t **)leaf = tree->free_leaves[c];
+  tree->free_leaves[c] = leaf;
+}
+
+static art_node_t *art_node_alloc(art_t *tree, uint8_t type) {
+  art_node_t *node = tree->free[type];
+
+  if (node != NULL) {
+    tree->free[type] = *(art_node_t **)node;
+  } else {
+    node = mem_heap_alloc(tree->heap, art_node_sizes[type]);
+  }
+
+  memset(node, 0, art_node_sizes[type]);
+  node->type = type;
+
+  return node;
+}
+
+static void art_node_release(art_t *tree, art_node_t *node) {
+  uint8_t type = node->type;
+
+  *(art_node_t **)node = tree->free[type];
+  tree->free[type] = node;
+}
+
+static void art_copy_header(art_node_t *dst, const art_node_t *src) {
+  dst->n_children = src->n_children;
+  dst->prefix_len = src->prefix_len;
+  memcpy(dst->prefix, src->prefix, min(src->prefix_len, ART_MAX_PREFIX));
+  dst->leaf = src->leaf;
+}
+
+static inline int art_node16_find(const art_node16_t *node, byte c) {
+#if defined(__SSE2__)
+  __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c), _mm_loadu_si128((const __m128i *)node->keys));
+  unsigned mask = (unsigned)_mm_movemask_epi8(cmp) & ((1u << node->n.n_children) - 1);
+
+  return mask != 0 ? __builtin_ctz(mask) : -1;
+#else
+  int i;
+
+  for (i = 0; i < node->n.n_children; i++) {
+    if (node->keys[i] == c) {
+      return i;
+    }
+  }
+
+  return -1;
+#endif
+}
+
+// Returns the slot of the first key greater than c.
+static inline size_t art_node16_upper(const art_node16_t *node, byte c) {
+#if defined(__SSE2__)
+  // SSE2 only compares signed bytes, flipping the top bit orders them as unsigned.
+  __m128i flip = _mm_set1_epi8((char)0x80);
+  __m128i keys = _mm_xor_si128(_mm_loadu_si128((const __m128i *)node->keys), flip);
+  __m128i cmp = _mm_cmpgt_epi8(keys, _mm_xor_si128(_mm_set1_epi8((char)c), flip));
+  unsigned mask = (unsigned)_mm_movemask_epi8(cmp) & ((1u << node->n.n_children) - 1);
+
+  return mask != 0 ? (size_t)__builtin_ctz(mask) : node->n.n_children;
+#else
+  size_t i;
+
+  for (i = 0; i < node->n.n_children && node->keys[i] <= c; i++) {
+  }
+
+  return i;
+#endif
+}
+
+static void **art_find_child(art_node_t *node, byte c) {
+  art_node4_t *n4;
+  art_node16_t *n16;
+  art_node48_t *n48;
+  art_node256_t *n256;
+  int i;
+
+  switch (node->type) {
+  case ART_NODE4:
+    n4 = (art_node4_t *)node;
+    for (i = 0; i < node->n_children; i++) {
+      if (n4->keys[i] == c) {
+        return &n4->children[i];
+      }
+    }
+    return NULL;
+  case ART_NODE16:
+    n16 = (art_node16_t *)node;
+    i = art_node16_find(n16, c);
+    return i >= 0 ? &n16->children[i] : NULL;
+  case ART_NODE48:
+    n48 = (art_node48_t *)node;
+    return n48->index[c] != 0 ? &n48->children[n48->index[c] - 1] : NULL;
+  default:
+    n256 = (art_node256_t *)node;
+    return n256->children[c] != NULL ? &n256->children[c] : NULL;
+  }
+}
+
+/* Returns the child after position *pos in key order and stores its key
+byte, or NULL past the last one. *pos starts at 0, for Node48 and Node256
+it is a key byte, so a scan may start at any byte. */
+static void *art_next_child(art_node_t *node, size_t *pos, byte *c) {
+  art_node4_t *n4;
+  art_node16_t *n16;
+  art_node48_t *n48;
+  art_node256_t *n256;
+
+  switch (node->type) {
+  case ART_NODE4:
+    n4 = (art_node4_t *)node;
+    if (*pos >= node->n_children) {
+      return NULL;
+    }
+    *c = n4->keys[*pos];
+    return n4->children[(*pos)++];
+  case ART_NODE16:
+    n16 = (art_node16_t *)node;
+    if (*pos >= node->n_children) {
+      return NULL;
+    }
+    *c = n16->keys[*pos];
+    return n16->children[(*pos)++];
+  case ART_NODE48:
+    n48 = (art_node48_t *)node;
+    for (; *pos < 256; (*pos)++) {
+      if (n48->index[*pos] != 0) {
+        *c = (byte)*pos;
+        return n48->children[n48->index[(*pos)++] - 1];
+      }
+    }
+    return NULL;
+  default:
+    n256 = (art_node256_t *)node;
+    for (; *pos < 256; (*pos)++) {
+      if (n256->children[*pos] != NULL) {
+        *c = (byte)*pos;
+        return n256->children[(*pos)++];
+      }
+    }
+    return NULL;
+  }
+}
+
+static art_leaf_t *art_minimum(void *p) {
+  art_node_t *node;
+  size_t pos;
+  byte c;
+
+  while (!ART_IS_LEAF(p)) {
+    node = p;
+    if (node->leaf != NULL) {
+      return node->leaf;
+    }
+    pos = 0;
+    p = art_next_child(node, &pos, &c);
+  }
+
+  return ART_UNTAG(p);
+}
+
+// Returns the full prefix of node, found at depth.
+static const byte *art_node_prefix(art_node_t *node, size_t depth) {
+  if (node->prefix_len <= ART_MAX_PREFIX) {
+    return node->prefix;
+  }
+
+  return art_minimum(node)->key + depth;
+}
+
+// Only compares the stored prefix bytes, the leaf reached checks the rest.
+static bool art_check_prefix(const art_node_t *node, const byte *key, size_t len, size_t depth) {
+  if (depth + node->prefix_len > len) {
+    return false;
+  }
+
+  return memcmp(node->prefix, key + depth, min(node->prefix_len, ART_MAX_PREFIX)) == 0;
+}
+
+// Returns the length of the common part of the full prefix of node and key.
+static size_t art_prefix_mismatch(art_node_t *node, const byte *key, size_t len, size_t depth) {
+  const byte *prefix = node->prefix;
+  size_t limit = min(node->prefix_len, len - depth);
+  size_t i;
+
+  for (i = 0; i < min(limit, ART_MAX_PREFIX); i++) {
+    if (prefix[i] != key[depth + i]) {
+      return i;
+    }
+  }
+
+  if (i < limit) {
+    prefix = art_minimum(node)->key + depth;
+    for (; i < limit; i++) {
+      if (prefix[i] != key[depth + i]) {
+        return i;
+      }
+    }
+  }
+
+  return i;
+}
+
+static void art_add_child(art_t *tree, void **ref, art_node_t *node, byte c, void *child) {
+  art_node4_t *n4;
+  art_node16_t *n16;
+  art_node48_t *n48;
+  art_node256_t *n256;
+  art_node_t *grown;
+  size_t i, pos;
+
+  switch (node->type) {
+  case ART_NODE4:
+    n4 = (art_node4_t *)node;
+    if (node->n_children < 4) {
+      for (pos = 0; pos < node->n_children && n4->keys[pos] < c; pos++) {
+      }
+      memmove(n4->keys + pos + 1, n4->keys + pos, node->n_children - pos);
+      memmove(n4->children + pos + 1, n4->children + pos, (node->n_children - pos) * sizeof(void *));
+      n4->keys[pos] = c;
+      n4->children[pos] = child;
+      node->n_children++;
+      return;
+    }
+    grown = art_node_alloc(tree, ART_NODE16);
+    n16 = (art_node16_t *)grown;
+    art_copy_header(grown, node);
+    memcpy(n16->keys, n4->keys, sizeof(n4->keys));
+    memcpy(n16->children, n4->children, sizeof(n4->children));
+    break;
+  case ART_NODE16:
+    n16 = (art_node16_t *)node;
+    if (node->n_children < 16) {
+      pos = art_node16_upper(n16, c);
+      memmove(n16->keys + pos + 1, n16->keys + pos, node->n_children - pos);
+      memmove(n16->children + pos + 1, n16->children + pos, (node->n_children - pos) * sizeof(void *));
+      n16->keys[pos] = c;
+      n16->children[pos] = child;
+      node->n_children++;
+      return;
+    }
+    grown = art_node_alloc(tree, ART_NODE48);
+    n48 = (art_node48_t *)grown;
+    art_copy_header(grown, node);
+    for (i = 0; i < 16; i++) {
+      n48->index[n16->keys[i]] = (byte)(i + 1);
+      n48->children[i] = n16->children[i];
+    }
+    break;
+  case ART_NODE48:
+    n48 = (art_node48_t *)node;
+    if (node->n_children < 48) {
+      for (pos = 0; n48->children[pos] != NULL; pos++) {
+      }
+      n48->children[pos] = child;
+      n48->index[c] = (byte)(pos + 1);
+      node->n_children++;
+      return;
+    }
+    grown = art_node_alloc(tree, ART_NODE256);
+    n256 = (art_node256_t *)grown;
+    art_copy_header(grown, node);
+    for (i = 0; i < 256; i++) {
+      if (n48->index[i] != 0) {
+        n256->children[i] = n48->children[n48->index[i] - 1];
+      }
+    }
+    break;
+  default:
+    n256 = (art_node256_t *)node;
+    n256->children[c] = child;
+    node->n_children++;
+    return;
+  }
+
+  *ref = grown;
+  art_node_release(tree, node);
+  art_add_child(tree, ref, grown, c, child);
+}
+
+// Hangs leaf off node, whose keys match leaf up to depth.
+static void art_add_leaf(art_t *tree, void **ref, art_node_t *node, art_leaf_t *leaf, size_t depth) {
+  if (leaf->key_len == depth) {
+    node->leaf = leaf;
+  } else {
+    art_add_child(tree, ref, node, leaf->key[depth], ART_TAG(leaf));
+  }
+}
+
+/* A Node4 left with a terminal leaf only is replaced by it, one left with
+a single child is merged into the child. */
+static void art_compact(art_t *tree, void **ref, art_node_t *node) {
+  art_node4_t *n4 = (art_node4_t *)node;
+  art_node_t *child;
+  byte prefix[ART_MAX_PREFIX];
+  size_t len, sub;
+
+  if (node->type != ART_NODE4) {
+    return;
+  }
+
+  if (node->n_children == 0) {
+    *ref = node->leaf != NULL ? ART_TAG(node->leaf) : NULL;
+    art_node_release(tree, node);
+    return;
+  }
+
+  if (node->n_children > 1 || node->leaf != NULL) {
+    return;
+  }
+
+  if (!ART_IS_LEAF(n4->children[0])) {
+    child = n4->children[0];
+    len = min(node->prefix_len, ART_MAX_PREFIX);
+    memcpy(prefix, node->prefix, len);
+    if (len < ART_MAX_PREFIX) {
+      prefix[len++] = n4->keys[0];
+    }
+    if (len < ART_MAX_PREFIX) {
+      sub = min(child->prefix_len, ART_MAX_PREFIX - len);
+      memcpy(prefix + len, child->prefix, sub);
+      len += sub;
+    }
+    memcpy(child->prefix, prefix, len);
+    child->prefix_len += node->prefix_len + 1;
+  }
+
+  *ref = n4->children[0];
+  art_node_release(tree, node);
+}
+
+static void art_remove_child(art_t *tree, void **ref, art_node_t *node, byte c, void **slot) {
+  art_node4_t *n4;
+  art_node16_t *n16;
+  art_node48_t *n48;
+  art_node256_t *n256;
+  art_node_t *shrunk;
+  size_t i, pos;
+
+  switch (node->type) {
+  case ART_NODE4:
+    n4 = (art_node4_t *)node;
+    pos = slot - n4->children;
+    memmove(n4->keys + pos, n4->keys + pos + 1, node->n_children - pos - 1);
+    memmove(n4->children + pos, n4->children + pos + 1, (node->n_children - pos - 1) * sizeof(void *));
+    node->n_children--;
+    art_compact(tree, ref, node);
+    return;
+  case ART_NODE16:
+    n16 = (art_node16_t *)node;
+    pos = slot - n16->children;
+    memmove(n16->keys + pos, n16->keys + pos + 1, node->n_children - pos - 1);
+    memmove(n16->children + pos, n16->children + pos + 1, (node->n_children - pos - 1) * sizeof(void *));
+    node->n_children--;
+    if (node->n_children > 3) {
+      return;
+    }
+    shrunk = art_node_alloc(tree, ART_NODE4);
+    n4 = (art_node4_t *)shrunk;
+    art_copy_header(shrunk, node);
+    memcpy(n4->keys, n16->keys, node->n_children);
+    memcpy(n4->children, n16->children, node->n_children * sizeof(void *));
+    break;
+  case ART_NODE48:
+    n48 = (art_node48_t *)node;
+    n48->children[n48->index[c] - 1] = NULL;
+    n48->index[c] = 0;
+    node->n_children--;
+    if (node->n_children > 12) {
+      return;
+    }
+    shrunk = art_node_alloc(tree, ART_NODE16);
+    n16 = (art_node16_t *)shrunk;
+    art_copy_header(shrunk, node);
+    for (i = 0, pos = 0; i < 256; i++) {
+      if (n48->index[i] != 0) {
+        n16->keys[pos] = (byte)i;
+        n16->children[pos++] = n48->children[n48->index[i] - 1];
+      }
+    }
+    break;
+  default:
+    n256 = (art_node256_t *)node;
+    n256->children[c] = NULL;
+    node->n_children--;
+    if (node->n_children > 37) {
+      return;
+    }
+    shrunk = art_node_alloc(tree, ART_NODE48);
+    n48 = (art_node48_t *)shrunk;
+    art_copy_header(shrunk, node);
+    for (i = 0, pos = 0; i < 256; i++) {
+      if (n256->children[i] != NULL) {
+        n48->children[pos++] = n256->children[i];
+        n48->index[i] = (byte)pos;
+      }
+    }
+    break;
+  }
+
+  *ref = shrunk;
+  art_node_release(tree, node);
+}
+
+void art_init(art_t *tree) {
+  memset(tree, 0, sizeof(*tree));
+  tree->heap = mem_heap_create(ART_HEAP_SIZE);
+}
+
+void art_destroy(art_t *tree) {
+  mem_heap_free(tree->heap);
+  tree->heap = NULL;
+  tree->root = NULL;
+  tree->size = 0;
+}
+
+void art_clear(art_t *tree) {
+  mem_heap_empty(tree->heap);
+  memset(tree->free, 0, sizeof(tree->free));
+  memset(tree->free_leaves, 0, sizeof(tree->free_leaves));
+  tree->root = NULL;
+  tree->size = 0;
+}
+
+size_t art_size(art_t *tree) {
+  return tree->size;
+}
+
+static bool art_insert_low(art_t *tree, void **ref, const byte *key, size_t len, size_t depth, void *value) {
+  void *p = *ref;
+  art_node_t *node, *split;
+  art_leaf_t *leaf;
+  void **child;
+  size_t diff;
+  byte c;
+
+  if (p == NULL) {
+    *ref = ART_TAG(art_leaf_create(tree, key, len, value));
+    return true;
+  }
+
+  if (ART_IS_LEAF(p)) {
+    leaf = ART_UNTAG(p);
+    if (art_leaf_matches(leaf, key, len)) {
+      leaf->value = value;
+      return false;
+    }
+    for (diff = depth; diff < min(leaf->key_len, len) && leaf->key[diff] == key[diff]; diff++) {
+    }
+    split = art_node_alloc(tree, ART_NODE4);
+    split->prefix_len = diff - depth;
+    memcpy(split->prefix, key + depth, min(diff - depth, ART_MAX_PREFIX));
+    *ref = split;
+    art_add_leaf(tree, ref, split, leaf, diff);
+    art_add_leaf(tree, ref, split, art_leaf_create(tree, key, len, value), diff);
+    return true;
+  }
+
+  node = p;
+
+  if (node->prefix_len > 0) {
+    diff = art_prefix_mismatch(node, key, len, depth);
+    if (diff < node->prefix_len) {
+      split = art_node_alloc(tree, ART_NODE4);
+      split->prefix_len = diff;
+      memcpy(split->prefix, node->prefix, min(diff, ART_MAX_PREFIX));
+      *ref = split;
+      if (node->prefix_len <= ART_MAX_PREFIX) {
+        c = node->prefix[diff];
+        node->prefix_len -= diff + 1;
+        memmove(node->prefix, node->prefix + diff + 1, node->prefix_len);
+      } else {
+        leaf = art_minimum(node);
+        c = leaf->key[depth + diff];
+        node->prefix_len -= diff + 1;
+        memcpy(node->prefix, leaf->key + depth + diff + 1, min(node->prefix_len, ART_MAX_PREFIX));
+      }
+      art_add_child(tree, ref, split, c, node);
+      art_add_leaf(tree, ref, split, art_leaf_create(tree, key, len, value), depth + diff);
+      return true;
+    }
+    depth += node->prefix_len;
+  }
+
+  if (depth == len) {
+    if (node->leaf != NULL) {
+      node->leaf->value = value;
+      return false;
+    }
+    node->leaf = art_leaf_create(tree, key, len, value);
+    return true;
+  }
+
+  child = art_find_child(node, key[depth]);
+
+  if (child != NULL) {
+    return art_insert_low(tree, child, key, len, depth + 1, value);
+  }
+
+  art_add_child(tree, ref, node, key[depth], ART_TAG(art_leaf_create(tree, key, len, value)));
+
+  return true;
+}
+
+bool art_insert(art_t *tree, const byte *key, size_t len, void *value) {
+  bool inserted = art_insert_low(tree, &tree->root, key, len, 0, value);
+
+  if (inserted) {
+    tree->size++;
+  }
+
+  return inserted;
+}
+
+bool art_find(art_t *tree, const byte *key, size_t len, void **value) {
+  void *p = tree->root;
+  art_node_t *node;
+  art_leaf_t *leaf = NULL;
+  void **child;
+  size_t depth = 0;
+
+  while (p != NULL) {
+    if (ART_IS_LEAF(p)) {
+      leaf = ART_UNTAG(p);
+      break;
+    }
+    node = p;
+    if (!art_check_prefix(node, key, len, depth)) {
+      return false;
+    }
+    depth += node->prefix_len;
+    if (depth == len) {
+      leaf = node->leaf;
+      break;
+    }
+    child = art_find_child(node, key[depth]);
+    p = child != NULL ? *child : NULL;
+    depth++;
+  }
+
+  if (leaf == NULL || !art_leaf_matches(leaf, key, len)) {
+    return false;
+  }
+
+  if (value != NULL) {
+    *value = leaf->value;
+  }
+
+  return true;
+}
+
+static bool art_erase_low(art_t *tree, void **ref, const byte *key, size_t len, size_t depth) {
+  void *p = *ref;
+  art_node_t *node;
+  void **child;
+
+  if (ART_IS_LEAF(p)) {
+    if (!art_leaf_matches(ART_UNTAG(p), key, len)) {
+      return false;
+    }
+    art_leaf_release(tree, ART_UNTAG(p));
+    *ref = NULL;
+    return true;
+  }
+
+  node = p;
+
+  if (!art_check_prefix(node, key, len, depth)) {
+    return false;
+  }
+
+  depth += node->prefix_len;
+
+  if (depth == len) {
+    if (node->leaf == NULL || !art_leaf_matches(node->leaf, key, len)) {
+      return false;
+    }
+    art_leaf_release(tree, node->leaf);
+    node->leaf = NULL;
+    art_compact(tree, ref, node);
+    return true;
+  }
+
+  child = art_find_child(node, key[depth]);
+
+  if (child == NULL) {
+    return false;
+  }
+
+  if (!ART_IS_LEAF(*child)) {
+    return art_erase_low(tree, child, key, len, depth + 1);
+  }
+
+  if (!art_leaf_matches(ART_UNTAG(*child), key, len)) {
+    return false;
+  }
+
+  art_leaf_release(tree, ART_UNTAG(*child));
+
+  art_remove_child(tree, ref, node, key[depth], child);
+
+  return true;
+}
+
+bool art_erase(art_t *tree, const byte *key, size_t len) {
+  if (tree->root == NULL || !art_erase_low(tree, &tree->root, key, len, 0)) {
+    return false;
+  }
+
+  tree->size--;
+
+  return true;
+}
+
+static int art_iter_low(void *p, art_callback_t callback, void *arg) {
+  art_node_t *node;
+  art_leaf_t *leaf;
+  void *child;
+  size_t pos = 0;
+  byte c;
+  int ret;
+
+  if (ART_IS_LEAF(p)) {
+    leaf = ART_UNTAG(p);
+    return callback(arg, leaf->key, leaf->key_len, leaf->value);
+  }
+
+  node = p;
+
+  if (node->leaf != NULL) {
+    ret = callback(arg, node->leaf->key, node->leaf->key_len, node->leaf->value);
+    if (ret != 0) {
+      return ret;
+    }
+  }
+
+  while ((child = art_next_child(node, &pos, &c)) != NULL) {
+    ret = art_iter_low(child, callback, arg);
+    if (ret != 0) {
+      return ret;
+    }
+  }
+
+  return 0;
+}
+
+int art_iter(art_t *tree, art_callback_t callback, void *arg) {
+  if (tree->root == NULL) {
+    return 0;
+  }
+
+  return art_iter_low(tree->root, callback, arg);
+}
+
+int art_iter_prefix(art_t *tree, const byte *prefix, size_t len, art_callback_t callback, void *arg) {
+  void *p = tree->root;
+  art_node_t *node;
+  art_leaf_t *leaf;
+  void **child;
+  size_t depth = 0;
+
+  while (p != NULL) {
+    if (ART_IS_LEAF(p)) {
+      leaf = ART_UNTAG(p);
+      if (leaf->key_len < len || memcmp(leaf->key, prefix, len) != 0) {
+        return 0;
+      }
+      return callback(arg, leaf->key, leaf->key_len, leaf->value);
+    }
+    node = p;
+    if (depth == len) {
+      return art_iter_low(p, callback, arg);
+    }
+    if (node->prefix_len > 0) {
+      if (memcmp(art_node_prefix(node, depth), prefix + depth, min(node->prefix_len, len - depth)) != 0) {
+        return 0;
+      }
+      depth += node->prefix_len;
+      if (depth >= len) {
+        return art_iter_low(p, callback, arg);
+      }
+    }
+    child = art_find_child(node, prefix[depth]);
+    p = child != NULL ? *child : NULL;
+    depth++;
+  }
+
+  return 0;
+}
+
+// Visits the keys of p not below lo, which matches them up to depth.
+static int art_iter_from(void *p, size_t depth, const byte *lo, size_t lo_len, art_callback_t callback, void *arg) {
+  art_node_t *node;
+  art_leaf_t *leaf;
+  const byte *prefix;
+  void *child;
+  size_t i, pos = 0;
+  byte c;
+  int ret;
+
+  if (ART_IS_LEAF(p)) {
+    leaf = ART_UNTAG(p);
+    if (art_key_compare(leaf->key, leaf->key_len, lo, lo_len) < 0) {
+      return 0;
+    }
+    return callback(arg, leaf->key, leaf->key_len, leaf->value);
+  }
+
+  node = p;
+  prefix = art_node_prefix(node, depth);
+
+  for (i = 0; i < node->prefix_len; i++) {
+    if (depth + i == lo_len || prefix[i] > lo[depth + i]) {
+      return art_iter_low(p, callback, arg);
+    }
+    if (prefix[i] < lo[depth + i]) {
+      return 0;
+    }
+  }
+
+  depth += node->prefix_len;
+
+  if (depth == lo_len) {
+    return art_iter_low(p, callback, arg);
+  }
+
+  // The terminal leaf is a proper prefix of lo, so it is skipped.
+  if (node->type >= ART_NODE48) {
+    pos = lo[depth];
+  }
+
+  while ((child = art_next_child(node, &pos, &c)) != NULL) {
+    if (c < lo[depth]) {
+      continue;
+    }
+    if (c == lo[depth]) {
+      ret = art_iter_from(child, depth + 1, lo, lo_len, callback, arg);
+    } else {
+      ret = art_iter_low(child, callback, arg);
+    }
+    if (ret != 0) {
+      return ret;
+    }
+  }
+
+  return 0;
+}
+
+static int art_range_callback(void *arg, const byte *key, size_t len, void *value) {
+  art_range_t *range = arg;
+
+  if (range->hi != NULL && art_key_compare(key, len, range->hi, range->hi_len) >= 0) {
+    range->done = true;
+    return 1;
+  }
+
+  return range->callback(range->arg, key, len, value);
+}
+
+int art_iter_range(art_t *tree, const byte *lo, size_t lo_len, const byte *hi, size_t hi_len, art_callback_t callback,
+                   void *arg) {
+  art_range_t range = {callback, arg, hi, hi_len, false};
+  int ret;
+
+  if (tree->root == NULL) {
+    return 0;
+  }
+
+  if (lo == NULL) {
+    ret = art_iter_low(tree->root, art_range_callback, &range);
+  } else {
+    ret = art_iter_from(tree->root, 0, lo, lo_len, art_range_callback, &range);
+  }
+
+  return range.done ? 0 : ret;
+}
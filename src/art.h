@@ -0,0 +1,114 @@
+/**
+ * @file art.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef ART_H
+#define ART_H
+#include "heap.h"
+#include "type.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ART_NODE4 0
+#define ART_NODE16 1
+#define ART_NODE48 2
+#define ART_NODE256 3
+
+// Prefix bytes kept in a node, longer prefixes are checked against a leaf.
+#define ART_MAX_PREFIX 12
+
+// Freed leaves are reused in MEM_ALIGNMENT steps up to this size, in powers of two above.
+#define ART_LEAF_STEP_MAX 256
+#define ART_LEAF_N_CLASSES (ART_LEAF_STEP_MAX / MEM_ALIGNMENT + 32)
+
+/* An adaptive radix tree over byte string keys, kept in lexicographic
+order. Inner nodes grow and shrink between 4, 16, 48 and 256 children,
+chains of single-child nodes are compressed into a prefix. A key may be a
+prefix of another one, its leaf then hangs off the inner node where it ends.
+Child pointers to leaves are tagged with the low bit. Leaves and nodes come
+from one heap, freed nodes are reused by type and freed leaves by size class,
+the heap is only released when the tree is cleared or destroyed. */
+typedef struct art_leaf_t art_leaf_t;
+struct art_leaf_t {
+    void *value;
+    uint32_t key_len;
+    byte key[];
+};
+
+typedef struct art_node_t art_node_t;
+struct art_node_t {
+    uint8_t type;
+    uint16_t n_children;
+    uint32_t prefix_len;
+    byte prefix[ART_MAX_PREFIX];
+    art_leaf_t *leaf;
+};
+
+typedef struct art_node4_t art_node4_t;
+struct art_node4_t {
+    art_node_t n;
+    byte keys[4];
+    void *children[4];
+};
+
+typedef struct art_node16_t art_node16_t;
+struct art_node16_t {
+    art_node_t n;
+    byte keys[16];
+    void *children[16];
+};
+
+// index holds the child slot plus one for each byte, 0 for none.
+typedef struct art_node48_t art_node48_t;
+struct art_node48_t {
+    art_node_t n;
+    byte index[256];
+    void *children[48];
+};
+
+typedef struct art_node256_t art_node256_t;
+struct art_node256_t {
+    art_node_t n;
+    void *children[256];
+};
+
+typedef struct art_t art_t;
+struct art_t {
+    void *root;
+    size_t size;
+    mem_heap_t *heap;
+    art_node_t *free[4];
+    art_leaf_t *free_leaves[ART_LEAF_N_CLASSES];
+};
+
+// Called in key order, a nonzero return stops the iteration and is passed up.
+typedef int (*art_callback_t)(void *arg, const byte *key, size_t len, void *value);
+
+void art_init(art_t *tree);
+
+void art_destroy(art_t *tree);
+
+// Drops all keys at once by emptying the heap.
+void art_clear(art_t *tree);
+
+size_t art_size(art_t *tree);
+
+// Returns false and replaces the value if the key is there.
+bool art_insert(art_t *tree, const byte *key, size_t len, void *value);
+
+bool art_find(art_t *tree, const byte *key, size_t len, void **value);
+
+bool art_erase(art_t *tree, const byte *key, size_t len);
+
+int art_iter(art_t *tree, art_callback_t callback, void *arg);
+
+// Visits the keys starting with prefix.
+int art_iter_prefix(art_t *tree, const byte *prefix, size_t len, art_callback_t callback, void *arg);
+
+/* Visits the keys in [lo, hi), a NULL bound is open. Subtrees below lo are
+skipped without visiting their leaves. */
+int art_iter_range(art_t *tree, const byte *lo, size_t lo_len, const byte *hi, size_t hi_len, art_callback_t callback,
+                   void *arg);
+
+#endif
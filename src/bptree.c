@@ -0,0 +1,396 @@
+/**
+ * @file bptree.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "bptree.h"
+#include "calc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#define BPT_MAX_HEIGHT 32
+
+static inline bool bpt_less(bpt_t *tree, bpt_key_t a, bpt_key_t b) {
+  if (tree->comp == NULL) {
+    return a < b;
+  }
+  return tree->comp((const void *)(intptr_t)a, (const void *)(intptr_t)b);
+}
+
+/* Number of keys less than key, or not greater than key if or_equal is set.
+That is the position of key in a leaf, or the child to descend into. */
+static inline size_t bpt_count_integer(const bpt_key_t *keys, size_t n, bpt_key_t key, bool or_equal) {
+  size_t count = 0;
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  __m256i k = _mm256_set1_epi64x(key);
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(keys + i));
+    // key > v[j] counts keys less than key, v[j] > key the ones greater
+    __m256i gt = or_equal ? _mm256_cmpgt_epi64(v, k) : _mm256_cmpgt_epi64(k, v);
+    unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(gt));
+    count += or_equal ? 4 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+#elif defined(__SSE4_2__)
+  __m128i k = _mm_set1_epi64x(key);
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(keys + i));
+    __m128i gt = or_equal ? _mm_cmpgt_epi64(v, k) : _mm_cmpgt_epi64(k, v);
+    unsigned mask = (unsigned)_mm_movemask_pd(_mm_castsi128_pd(gt));
+    count += or_equal ? 2 - __builtin_popcount(mask) : __builtin_popcount(mask);
+  }
+#endif
+  // branch free so that the compiler may vectorize it as well
+  for (; i < n; i++) {
+    count += or_equal ? keys[i] <= key : keys[i] < key;
+  }
+
+  return count;
+}
+
+static inline size_t bpt_search(bpt_t *tree, const bpt_key_t *keys, size_t n, bpt_key_t key, bool or_equal) {
+  size_t lo = 0;
+  size_t hi = n;
+  size_t mid;
+
+  if (tree->comp == NULL) {
+    return bpt_count_integer(keys, n, key, or_equal);
+  }
+
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (or_equal ? !bpt_less(tree, key, keys[mid]) : bpt_less(tree, keys[mid], key)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static bpt_leaf_t *bpt_leaf_create(bpt_t *tree) {
+  bpt_leaf_t *leaf = (bpt_leaf_t *)mem_pool_alloc(tree->pool);
+
+  leaf->node.n_keys = 0;
+  leaf->node.is_leaf = 1;
+  leaf->prev = NULL;
+  leaf->next = NULL;
+
+  return leaf;
+}
+
+static bpt_inner_t *bpt_inner_create(bpt_t *tree) {
+  bpt_inner_t *inner = (bpt_inner_t *)mem_pool_alloc(tree->pool);
+
+  inner->node.n_keys = 0;
+  inner->node.is_leaf = 0;
+
+  return inner;
+}
+
+void bpt_init(bpt_t *tree, Compare comp) {
+  tree->comp = comp;
+  tree->pool = mem_pool_create_aligned(BPT_NODE_SIZE, 0, CACHE_LINE_SIZE);
+  tree->first = bpt_leaf_create(tree);
+  tree->root = &tree->first->node;
+  tree->count = 0;
+  tree->height = 1;
+}
+
+void bpt_destroy(bpt_t *tree) {
+  mem_pool_free(tree->pool);
+}
+
+void bpt_clear(bpt_t *tree) {
+  mem_pool_empty(tree->pool);
+  tree->first = bpt_leaf_create(tree);
+  tree->root = &tree->first->node;
+  tree->count = 0;
+  tree->height = 1;
+}
+
+size_t bpt_size(bpt_t *tree) {
+  return tree->count;
+}
+
+static bpt_leaf_t *bpt_find_leaf(bpt_t *tree, bpt_key_t key) {
+  bpt_node_t *node = tree->root;
+  bpt_inner_t *inner;
+
+  while (!node->is_leaf) {
+    inner = (bpt_inner_t *)node;
+    node = inner->children[bpt_search(tree, inner->keys, inner->node.n_keys, key, true)];
+  }
+
+  return (bpt_leaf_t *)node;
+}
+
+bool bpt_find(bpt_t *tree, bpt_key_t key, void **value) {
+  bpt_leaf_t *leaf = bpt_find_leaf(tree, key);
+  size_t pos = bpt_search(tree, leaf->keys, leaf->node.n_keys, key, false);
+
+  if (pos == leaf->node.n_keys || bpt_less(tree, key, leaf->keys[pos])) {
+    return false;
+  }
+  if (value != NULL) {
+    *value = leaf->values[pos];
+  }
+  return true;
+}
+
+static void bpt_leaf_insert_at(bpt_leaf_t *leaf, size_t pos, bpt_key_t key, void *value) {
+  size_t n = leaf->node.n_keys;
+
+  memmove(leaf->keys + pos + 1, leaf->keys + pos, (n - pos) * sizeof(bpt_key_t));
+  memmove(leaf->values + pos + 1, leaf->values + pos, (n - pos) * sizeof(void *));
+  leaf->keys[pos] = key;
+  leaf->values[pos] = value;
+  leaf->node.n_keys++;
+}
+
+// Inserts key and its right child at pos of a node with room for them.
+static void bpt_inner_insert_at(bpt_inner_t *inner, size_t pos, bpt_key_t key, bpt_node_t *child) {
+  size_t n = inner->node.n_keys;
+
+  memmove(inner->keys + pos + 1, inner->keys + pos, (n - pos) * sizeof(bpt_key_t));
+  memmove(inner->children + pos + 2, inner->children + pos + 1, (n - pos) * sizeof(bpt_node_t *));
+  inner->keys[pos] = key;
+  inner->children[pos + 1] = child;
+  inner->node.n_keys++;
+}
+
+bool bpt_insert(bpt_t *tree, bpt_key_t key, void *value) {
+  bpt_inner_t *path[BPT_MAX_HEIGHT];
+  size_t slots[BPT_MAX_HEIGHT];
+  size_t depth = 0;
+  bpt_node_t *node = tree->root;
+  bpt_leaf_t *leaf;
+  bpt_leaf_t *right;
+  bpt_inner_t *inner;
+  bpt_inner_t *sibling;
+  bpt_node_t *child;
+  bpt_key_t sep;
+  bpt_key_t up;
+  size_t pos;
+  size_t n;
+  size_t half;
+
+  while (!node->is_leaf) {
+    inner = (bpt_inner_t *)node;
+    path[depth] = inner;
+    slots[depth] = bpt_search(tree, inner->keys, inner->node.n_keys, key, true);
+    node = inner->children[slots[depth]];
+    depth++;
+  }
+
+  leaf = (bpt_leaf_t *)node;
+  n = leaf->node.n_keys;
+  pos = bpt_search(tree, leaf->keys, n, key, false);
+  if (pos < n && !bpt_less(tree, key, leaf->keys[pos])) {
+    return false;
+  }
+
+  tree->count++;
+
+  if (n < BPT_LEAF_CAP) {
+    bpt_leaf_insert_at(leaf, pos, key, value);
+    return true;
+  }
+
+  // split the full leaf, the upper half moves to a new right sibling
+  right = bpt_leaf_create(tree);
+  half = (BPT_LEAF_CAP + 1) / 2;
+  right->node.n_keys = n - half;
+  memcpy(right->keys, leaf->keys + half, right->node.n_keys * sizeof(bpt_key_t));
+  memcpy(right->values, leaf->values + half, right->node.n_keys * sizeof(void *));
+  leaf->node.n_keys = half;
+
+  right->next = leaf->next;
+  right->prev = leaf;
+  if (leaf->next != NULL) {
+    leaf->next->prev = right;
+  }
+  leaf->next = right;
+
+  if (pos <= half) {
+    bpt_leaf_insert_at(leaf, pos, key, value);
+  } else {
+    bpt_leaf_insert_at(right, pos - half, key, value);
+  }
+
+  sep = right->keys[0];
+  child = &right->node;
+
+  // push the separator up, splitting full inner nodes on the way
+  while (depth > 0) {
+    depth--;
+    inner = path[depth];
+    pos = slots[depth];
+
+    if (inner->node.n_keys < BPT_INNER_CAP) {
+      bpt_inner_insert_at(inner, pos, sep, child);
+      return true;
+    }
+
+    sibling = bpt_inner_create(tree);
+    half = BPT_INNER_CAP / 2;
+
+    if (pos < half) {
+      // the key at half - 1 goes up, the new key stays on the left
+      sibling->node.n_keys = BPT_INNER_CAP - half;
+      memcpy(sibling->keys, inner->keys + half, sibling->node.n_keys * sizeof(bpt_key_t));
+      memcpy(sibling->children, inner->children + half, (sibling->node.n_keys + 1) * sizeof(bpt_node_t *));
+      inner->node.n_keys = half - 1;
+      up = inner->keys[half - 1];
+      bpt_inner_insert_at(inner, pos, sep, child);
+      sep = up;
+    } else if (pos == half) {
+      // the new key itself goes up
+      sibling->node.n_keys = BPT_INNER_CAP - half;
+      memcpy(sibling->keys, inner->keys + half, sibling->node.n_keys * sizeof(bpt_key_t));
+      memcpy(sibling->children + 1, inner->children + half + 1, sibling->node.n_keys * sizeof(bpt_node_t *));
+      sibling->children[0] = child;
+      inner->node.n_keys = half;
+    } else {
+      // the key at half goes up, the new key goes right
+      sibling->node.n_keys = BPT_INNER_CAP - half - 1;
+      memcpy(sibling->keys, inner->keys + half + 1, sibling->node.n_keys * sizeof(bpt_key_t));
+      memcpy(sibling->children, inner->children + half + 1, (sibling->node.n_keys + 1) * sizeof(bpt_node_t *));
+      inner->node.n_keys = half;
+      up = inner->keys[half];
+      bpt_inner_insert_at(sibling, pos - half - 1, sep, child);
+      sep = up;
+    }
+
+    child = &sibling->node;
+  }
+
+  // the root was split
+  inner = bpt_inner_create(tree);
+  inner->node.n_keys = 1;
+  inner->keys[0] = sep;
+  inner->children[0] = tree->root;
+  inner->children[1] = child;
+  tree->root = &inner->node;
+  tree->height++;
+  assert(tree->height < BPT_MAX_HEIGHT);
+
+  return true;
+}
+
+bool bpt_erase(bpt_t *tree, bpt_key_t key) {
+  bpt_leaf_t *leaf = bpt_find_leaf(tree, key);
+  size_t n = leaf->node.n_keys;
+  size_t pos = bpt_search(tree, leaf->keys, n, key, false);
+
+  if (pos == n || bpt_less(tree, key, leaf->keys[pos])) {
+    return false;
+  }
+
+  memmove(leaf->keys + pos, leaf->keys + pos + 1, (n - pos - 1) * sizeof(bpt_key_t));
+  memmove(leaf->values + pos, leaf->values + pos + 1, (n - pos - 1) * sizeof(void *));
+  leaf->node.n_keys--;
+  tree->count--;
+
+  return true;
+}
+
+void bpt_bulk_load(bpt_t *tree, vector_t *entries) {
+  size_t n = vector_size(entries);
+  size_t n_nodes;
+  size_t n_parents;
+  size_t i;
+  size_t j;
+  bpt_node_t **level;
+  bpt_key_t *mins;
+  bpt_leaf_t *leaf = tree->first;
+  bpt_entry_t *entry;
+  bpt_inner_t *inner;
+
+  assert(tree->count == 0 && tree->root == &tree->first->node);
+  assert(entries->sizeof_value == sizeof(bpt_entry_t));
+
+  if (n == 0) {
+    return;
+  }
+
+  n_nodes = (n + BPT_LEAF_CAP - 1) / BPT_LEAF_CAP;
+  level = (bpt_node_t **)malloc(n_nodes * sizeof(bpt_node_t *));
+  mins = (bpt_key_t *)malloc(n_nodes * sizeof(bpt_key_t));
+  assert(level && mins);
+
+  // fill leaves left to right, reusing the empty first leaf
+  for (i = 0; i < n_nodes; i++) {
+    if (i > 0) {
+      leaf->next = bpt_leaf_create(tree);
+      leaf->next->prev = leaf;
+      leaf = leaf->next;
+    }
+    for (j = i * BPT_LEAF_CAP; j < min((i + 1) * BPT_LEAF_CAP, n); j++) {
+      entry = (bpt_entry_t *)vector_at(entries, j);
+      assert(j == 0 || bpt_less(tree, ((bpt_entry_t *)vector_at(entries, j - 1))->key, entry->key));
+      leaf->keys[leaf->node.n_keys] = entry->key;
+      leaf->values[leaf->node.n_keys] = entry->value;
+      leaf->node.n_keys++;
+    }
+    level[i] = &leaf->node;
+    mins[i] = leaf->keys[0];
+  }
+
+  // each level groups up to BPT_INNER_CAP + 1 children under a parent
+  while (n_nodes > 1) {
+    n_parents = (n_nodes + BPT_INNER_CAP) / (BPT_INNER_CAP + 1);
+    for (i = 0; i < n_parents; i++) {
+      inner = bpt_inner_create(tree);
+      for (j = i * (BPT_INNER_CAP + 1); j < min((i + 1) * (BPT_INNER_CAP + 1), n_nodes); j++) {
+        if (j > i * (BPT_INNER_CAP + 1)) {
+          inner->keys[inner->node.n_keys++] = mins[j];
+        }
+        inner->children[inner->node.n_keys] = level[j];
+      }
+      mins[i] = mins[i * (BPT_INNER_CAP + 1)];
+      level[i] = &inner->node;
+    }
+    n_nodes = n_parents;
+    tree->height++;
+  }
+
+  tree->root = level[0];
+  tree->count = n;
+
+  free(level);
+  free(mins);
+}
+
+// Moves a cursor past the end of its leaf onto the next non empty one.
+static void bpt_cursor_skip(bpt_cursor_t *cursor) {
+  while (cursor->leaf != NULL && cursor->pos >= cursor->leaf->node.n_keys) {
+    cursor->leaf = cursor->leaf->next;
+    cursor->pos = 0;
+  }
+}
+
+void bpt_begin(bpt_t *tree, bpt_cursor_t *cursor) {
+  cursor->leaf = tree->first;
+  cursor->pos = 0;
+  bpt_cursor_skip(cursor);
+}
+
+void bpt_lower_bound(bpt_t *tree, bpt_key_t key, bpt_cursor_t *cursor) {
+  cursor->leaf = bpt_find_leaf(tree, key);
+  cursor->pos = bpt_search(tree, cursor->leaf->keys, cursor->leaf->node.n_keys, key, false);
+  bpt_cursor_skip(cursor);
+}
+
+void bpt_cursor_next(bpt_cursor_t *cursor) {
+  assert(bpt_cursor_valid(cursor));
+  cursor->pos++;
+  bpt_cursor_skip(cursor);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file bptree.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef BPTREE_H
+#define BPTREE_H
+#include "pool.h"
+#include "type.h"
+#include "vec.h"
+#include <stdint.h>
+
+/* An in-memory B+-tree mapping keys to void * values. Nodes are
+BPT_NODE_SIZE bytes, cache line aligned, and come from a mem_pool_t; keys sit
+in their own array at the front of a node so a search touches few lines.
+Without a Compare keys are signed integers searched with SIMD, with one they
+are pointers to the caller's keys and searched in binary. Leaves are linked
+for range scans. Erase is lazy: entries are removed from their leaf but
+nodes are never merged, the separators stay valid as bounds. */
+#ifndef BPT_NODE_SIZE
+#define BPT_NODE_SIZE 512
+#endif
+
+typedef int64_t bpt_key_t;
+
+typedef struct bpt_node_t bpt_node_t;
+struct bpt_node_t {
+    uint32_t n_keys;
+    uint32_t is_leaf;
+};
+
+#define BPT_LEAF_CAP ((BPT_NODE_SIZE - sizeof(bpt_node_t) - 2 * sizeof(void *)) / (sizeof(bpt_key_t) + sizeof(void *)))
+#define BPT_INNER_CAP ((BPT_NODE_SIZE - sizeof(bpt_node_t) - sizeof(void *)) / (sizeof(bpt_key_t) + sizeof(void *)))
+
+typedef struct bpt_leaf_t bpt_leaf_t;
+struct bpt_leaf_t {
+    bpt_node_t node;
+    bpt_key_t keys[BPT_LEAF_CAP];
+    void *values[BPT_LEAF_CAP];
+    bpt_leaf_t *prev;
+    bpt_leaf_t *next;
+};
+
+// Keys of children[i + 1] are not less than keys[i].
+typedef struct bpt_inner_t bpt_inner_t;
+struct bpt_inner_t {
+    bpt_node_t node;
+    bpt_key_t keys[BPT_INNER_CAP];
+    bpt_node_t *children[BPT_INNER_CAP + 1];
+};
+
+typedef struct bpt_t bpt_t;
+struct bpt_t {
+    bpt_node_t *root;
+    bpt_leaf_t *first;
+    size_t count;
+    size_t height;
+    Compare comp;
+    mem_pool_t *pool;
+};
+
+// Entry of the sorted vector_t given to bpt_bulk_load.
+typedef struct bpt_entry_t bpt_entry_t;
+struct bpt_entry_t {
+    bpt_key_t key;
+    void *value;
+};
+
+typedef struct bpt_cursor_t bpt_cursor_t;
+struct bpt_cursor_t {
+    bpt_leaf_t *leaf;
+    size_t pos;
+};
+
+// comp may be NULL for integer keys.
+void bpt_init(bpt_t *tree, Compare comp);
+
+void bpt_destroy(bpt_t *tree);
+
+void bpt_clear(bpt_t *tree);
+
+size_t bpt_size(bpt_t *tree);
+
+// Returns false and leaves the tree unchanged if key is already there.
+bool bpt_insert(bpt_t *tree, bpt_key_t key, void *value);
+
+bool bpt_find(bpt_t *tree, bpt_key_t key, void **value);
+
+bool bpt_erase(bpt_t *tree, bpt_key_t key);
+
+/* Builds the tree from a vector_t of bpt_entry_t sorted by key without
+duplicates, leaves are filled up. The tree must be empty. */
+void bpt_bulk_load(bpt_t *tree, vector_t *entries);
+
+void bpt_begin(bpt_t *tree, bpt_cursor_t *cursor);
+
+// Positions the cursor on the first key not less than key.
+void bpt_lower_bound(bpt_t *tree, bpt_key_t key, bpt_cursor_t *cursor);
+
+static inline bool bpt_cursor_valid(const bpt_cursor_t *cursor) {
+  return cursor->leaf != NULL;
+}
+
+static inline bpt_key_t bpt_cursor_key(const bpt_cursor_t *cursor) {
+  return cursor->leaf->keys[cursor->pos];
+}
+
+static inline void *bpt_cursor_value(const bpt_cursor_t *cursor) {
+  return cursor->leaf->values[cursor->pos];
+}
+
+void bpt_cursor_next(bpt_cursor_t *cursor);
+
+#endif
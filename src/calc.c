@@ -1,5 +1,6 @@
 #include "calc.h"
 #include <assert.h>
+#include <string.h>
 
 #define HASH_RANDOM_MASK 1463735687
 #define HASH_RANDOM_MASK2 1653893711
@@ -86,55 +87,207 @@ size_t calc_fold_pair(size_t n1, size_t n2) {
   return (((((n1 ^ n2 ^ HASH_RANDOM_MASK2) << 8) + n1) ^ HASH_RANDOM_MASK) + n2);
 }
 
-size_t calc_fold_uint64(uint64_t d) {
-  return (calc_fold_pair((size_t)d & UINT32_MASK, (size_t)(d >> 32)));
+/* 64-bit hashing in the style of wyhash: words are read 8 at a time, mixed
+with a 64x64->128 multiply folded back to 64 bits, and long inputs run three
+independent lanes over 48-byte stripes. */
+static const uint64_t calc_hash_secret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                             0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+static inline void calc_hash_mum(uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+  __uint128_t r = (__uint128_t)*a * *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
 }
 
-size_t calc_fold_string(const char *str) {
-  size_t fold = 0;
+static inline uint64_t calc_hash_mix(uint64_t a, uint64_t b) {
+  calc_hash_mum(&a, &b);
+  return a ^ b;
+}
+
+static inline uint64_t calc_hash_r8(const byte *p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+
+static inline uint64_t calc_hash_r4(const byte *p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+// Reads 1 to 3 bytes.
+static inline uint64_t calc_hash_r3(const byte *p, size_t k) {
+  return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+static inline uint64_t calc_hash_seed(uint64_t seed) {
+  return seed ^ calc_hash_mix(seed ^ calc_hash_secret[0], calc_hash_secret[1]);
+}
+
+static inline void calc_hash_stripe(const byte *p, uint64_t *seed, uint64_t *see1, uint64_t *see2) {
+  *seed = calc_hash_mix(calc_hash_r8(p) ^ calc_hash_secret[1], calc_hash_r8(p + 8) ^ *seed);
+  *see1 = calc_hash_mix(calc_hash_r8(p + 16) ^ calc_hash_secret[2], calc_hash_r8(p + 24) ^ *see1);
+  *see2 = calc_hash_mix(calc_hash_r8(p + 32) ^ calc_hash_secret[3], calc_hash_r8(p + 40) ^ *see2);
+}
+
+/* Hashes the last i < 48 bytes at p of an input of len > 16 bytes. The final
+words may overlap bytes before p, which belong to the same input. */
+static inline uint64_t calc_hash_tail(const byte *p, size_t i, size_t len, uint64_t seed) {
+  uint64_t a;
+  uint64_t b;
+
+  while (i > 16) {
+    seed = calc_hash_mix(calc_hash_r8(p) ^ calc_hash_secret[1], calc_hash_r8(p + 8) ^ seed);
+    i -= 16;
+    p += 16;
+  }
+  a = calc_hash_r8(p + i - 16) ^ calc_hash_secret[1];
+  b = calc_hash_r8(p + i - 8) ^ seed;
+  calc_hash_mum(&a, &b);
+  return calc_hash_mix(a ^ calc_hash_secret[0] ^ len, b ^ calc_hash_secret[1]);
+}
+
+static inline uint64_t calc_hash_short(const byte *p, size_t len, uint64_t seed) {
+  uint64_t a;
+  uint64_t b;
+
+  if (len >= 4) {
+    a = (calc_hash_r4(p) << 32) | calc_hash_r4(p + ((len >> 3) << 2));
+    b = (calc_hash_r4(p + len - 4) << 32) | calc_hash_r4(p + len - 4 - ((len >> 3) << 2));
+  } else if (len > 0) {
+    a = calc_hash_r3(p, len);
+    b = 0;
+  } else {
+    a = b = 0;
+  }
+  a ^= calc_hash_secret[1];
+  b ^= seed;
+  calc_hash_mum(&a, &b);
+  return calc_hash_mix(a ^ calc_hash_secret[0] ^ len, b ^ calc_hash_secret[1]);
+}
+
+uint64_t calc_hash_binary(const void *data, size_t len, uint64_t seed) {
+  const byte *p = (const byte *)data;
+  size_t i = len;
+  uint64_t see1;
+  uint64_t see2;
+
+  assert(data || !len);
+
+  seed = calc_hash_seed(seed);
+
+  if (len <= 16) {
+    return calc_hash_short(p, len, seed);
+  }
+
+  if (i >= 48) {
+    see1 = seed;
+    see2 = seed;
+    do {
+      calc_hash_stripe(p, &seed, &see1, &see2);
+      p += 48;
+      i -= 48;
+    } while (i >= 48);
+    seed ^= see1 ^ see2;
+  }
+
+  return calc_hash_tail(p, i, len, seed);
+}
+
+uint64_t calc_hash_string(const char *str, uint64_t seed) {
   assert(str);
-  while (*str != '\0') {
-    fold += calc_fold_pair(fold, (size_t)(*str));
-    str++;
+  return calc_hash_binary(str, strlen(str), seed);
+}
+
+uint64_t calc_hash_uint64(uint64_t d, uint64_t seed) {
+  uint64_t a = d ^ calc_hash_secret[0];
+  uint64_t b = seed ^ calc_hash_secret[1];
+  calc_hash_mum(&a, &b);
+  return calc_hash_mix(a ^ calc_hash_secret[0], b ^ calc_hash_secret[1]);
+}
+
+void calc_hash_init(calc_hash_state_t *state, uint64_t seed) {
+  state->seed = calc_hash_seed(seed);
+  state->see1 = state->seed;
+  state->see2 = state->seed;
+  state->len = 0;
+  state->n_buf = 0;
+}
+
+/* buf keeps the last 16 bytes of the stripes already hashed followed by up to
+48 pending bytes, so the tail can overlap into the previous stripe exactly as
+calc_hash_binary does. */
+void calc_hash_update(calc_hash_state_t *state, const void *data, size_t len) {
+  const byte *p = (const byte *)data;
+  size_t n;
+
+  assert(data || !len);
+
+  state->len += len;
+
+  if (state->n_buf > 0) {
+    n = min(CALC_HASH_STRIPE - state->n_buf, len);
+    memcpy(state->buf + 16 + state->n_buf, p, n);
+    state->n_buf += n;
+    p += n;
+    len -= n;
+
+    if (state->n_buf < CALC_HASH_STRIPE) {
+      return;
+    }
+    calc_hash_stripe(state->buf + 16, &state->seed, &state->see1, &state->see2);
+    memcpy(state->buf, state->buf + CALC_HASH_STRIPE, 16);
+    state->n_buf = 0;
   }
-  return fold;
+
+  if (len >= CALC_HASH_STRIPE) {
+    do {
+      calc_hash_stripe(p, &state->seed, &state->see1, &state->see2);
+      p += CALC_HASH_STRIPE;
+      len -= CALC_HASH_STRIPE;
+    } while (len >= CALC_HASH_STRIPE);
+    memcpy(state->buf, p - 16, 16);
+  }
+
+  memcpy(state->buf + 16, p, len);
+  state->n_buf = len;
 }
 
-size_t calc_fold_binary(const byte *str, size_t len) {
-  size_t fold = 0;
-  const byte *str_end = str + (len & 0xFFFFFFF8);
-
-  assert(str || !len);
-
-  while (str < str_end) {
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-    fold = calc_fold_pair(fold, (size_t)(*str++));
+uint64_t calc_hash_final(const calc_hash_state_t *state) {
+  uint64_t seed = state->seed;
+
+  if (state->len <= 16) {
+    return calc_hash_short(state->buf + 16, state->len, seed);
   }
 
-  switch (len & 0x7) {
-  case 7:
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-  case 6:
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-  case 5:
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-  case 4:
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-  case 3:
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-  case 2:
-    fold = calc_fold_pair(fold, (size_t)(*str++));
-  case 1:
-    fold = calc_fold_pair(fold, (size_t)(*str++));
+  if (state->len >= CALC_HASH_STRIPE) {
+    seed ^= state->see1 ^ state->see2;
   }
 
-  return (fold);
+  return calc_hash_tail(state->buf + 16, state->n_buf, state->len, seed);
+}
+
+size_t calc_fold_uint64(uint64_t d) {
+  return (size_t)calc_hash_uint64(d, 0);
+}
+
+size_t calc_fold_string(const char *str) {
+  return (size_t)calc_hash_string(str, 0);
+}
+
+size_t calc_fold_binary(const byte *str, size_t len) {
+  return (size_t)calc_hash_binary(str, len, 0);
 }
 
 uint64_t uint64_create(size_t high, size_t low) {
@@ -24,6 +24,9 @@
 // Calculates the smallest multiple of m that is not smaller than n
 #define calc_align(n, m) (((n) + ((m) - 1)) & ~((m) - 1))
 
+// Size of a CPU cache line, used to keep hot shared data apart.
+#define CACHE_LINE_SIZE 64
+
 // Determine how many bytes (groups of 8 bits) are needed to store the given number of bits.
 #define BITS_IN_BYTES(b) (((b) + 7) / 8)
 
@@ -40,6 +43,33 @@ size_t calc_find_prime(size_t n);
 
 size_t calc_fold_pair(size_t n1, size_t n2);
 
+// Seeded 64-bit hashes, word at a time, for binary, string and integer keys.
+uint64_t calc_hash_binary(const void *data, size_t len, uint64_t seed);
+
+uint64_t calc_hash_string(const char *str, uint64_t seed);
+
+uint64_t calc_hash_uint64(uint64_t d, uint64_t seed);
+
+#define CALC_HASH_STRIPE 48
+
+// Incremental form of calc_hash_binary, any split of the input gives the same hash.
+typedef struct calc_hash_state_t calc_hash_state_t;
+struct calc_hash_state_t {
+  uint64_t seed;
+  uint64_t see1;
+  uint64_t see2;
+  size_t len;
+  size_t n_buf;
+  byte buf[16 + CALC_HASH_STRIPE];
+};
+
+void calc_hash_init(calc_hash_state_t *state, uint64_t seed);
+
+void calc_hash_update(calc_hash_state_t *state, const void *data, size_t len);
+
+uint64_t calc_hash_final(const calc_hash_state_t *state);
+
+// Folds for HASH_INSERT and HASH_SEARCH, calc_hash_* with seed 0.
 size_t calc_fold_uint64(uint64_t d);
 
 size_t calc_fold_string(const char *str);
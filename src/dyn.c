@@ -4,15 +4,34 @@
  * @author yuesong-feng
  */
 #include "dyn.h"
+#include "calc.h"
 #include <assert.h>
+#include <errno.h>
 #include <string.h>
+#include <unistd.h>
 
-#define DYN_BLOCK_FULL_FLAG 0x1000000UL
+#define DYN_BLOCK_FULL_FLAG ((size_t)1 << (sizeof(size_t) * CHAR_BIT - 1))
+#define DYN_BLOCK_HEADER_SIZE offsetof(dyn_block_t, buf)
+#define DYN_ARRAY_INDEX_START_SIZE 8
+#define DYN_ARRAY_IOV_BATCH 64
 
 dyn_array_t *dyn_array_create(dyn_array_t *arr) {
+  return dyn_array_create_sized(arr, DYN_ARRAY_DATA_SIZE, DYN_ARRAY_MAX_BLOCK_SIZE);
+}
+
+dyn_array_t *dyn_array_create_sized(dyn_array_t *arr, size_t block_size, size_t max_block_size) {
   assert(arr);
+  assert(block_size);
+  assert(block_size <= max_block_size);
   arr->heap = NULL;
   arr->used = 0;
+  arr->size = DYN_ARRAY_DATA_SIZE;
+  arr->offset = 0;
+  arr->data = arr->buf;
+  arr->index = NULL;
+  arr->index_size = 0;
+  arr->block_size = block_size;
+  arr->max_block_size = max_block_size;
   return arr;
 }
 
@@ -21,49 +40,106 @@ void dyn_array_free(dyn_array_t *arr) {
     mem_heap_free(arr->heap);
 }
 
-static dyn_block_t *dyn_array_add_block(dyn_array_t *arr) {
+/* Blocks other than the last one never change size, so each block records the
+offset of its first byte, and the first block keeps an array of all blocks
+that can be binary searched by offset. */
+static void dyn_array_index_add(dyn_array_t *arr, dyn_block_t *block) {
+  dyn_block_t **index;
+  size_t n_blocks;
+
+  n_blocks = LIST_GET_LEN(arr->base);
+
+  if (n_blocks > arr->index_size) {
+    index = mem_heap_alloc(arr->heap, 2 * arr->index_size * sizeof(*index));
+    memcpy(index, arr->index, arr->index_size * sizeof(*index));
+    arr->index = index;
+    arr->index_size *= 2;
+  }
+
+  arr->index[n_blocks - 1] = block;
+}
+
+// Adds a block with room for at least size bytes.
+static dyn_block_t *dyn_array_add_block(dyn_array_t *arr, size_t size) {
   mem_heap_t *heap;
   dyn_block_t *block;
+  dyn_block_t *last;
 
   assert(arr);
 
-  if (arr->heap != NULL) {
+  if (arr->heap == NULL) {
     LIST_INIT(arr->base);
     LIST_ADD_FIRST(list, arr->base, arr);
     arr->heap = mem_heap_create(sizeof(dyn_block_t));
+    arr->index_size = DYN_ARRAY_INDEX_START_SIZE;
+    arr->index = mem_heap_alloc(arr->heap, arr->index_size * sizeof(*arr->index));
+    arr->index[0] = arr;
   }
 
-  block = dyn_array_get_last_block(arr);
-  block->used = block->used | DYN_BLOCK_FULL_FLAG;
+  last = dyn_array_get_last_block(arr);
+  last->used = last->used | DYN_BLOCK_FULL_FLAG;
 
   heap = arr->heap;
 
-  block = (dyn_block_t *)mem_heap_alloc(heap, sizeof(dyn_block_t));
+  if (size <= arr->block_size) {
+    size = arr->block_size;
+    arr->block_size = min(2 * arr->block_size, arr->max_block_size);
+  }
+
+  block = (dyn_block_t *)mem_heap_alloc(heap, DYN_BLOCK_HEADER_SIZE + size);
   block->used = 0;
+  block->size = size;
+  block->offset = last->offset + dyn_block_get_used(last);
+  block->data = (byte *)block + DYN_BLOCK_HEADER_SIZE;
 
   LIST_ADD_LAST(list, arr->base, block);
 
+  dyn_array_index_add(arr, block);
+
   return block;
 }
 
+// Finds the block that holds byte pos, pos may be the end of the array.
+static const dyn_block_t *dyn_array_find_block(const dyn_array_t *arr, size_t pos) {
+  size_t low;
+  size_t high;
+  size_t mid;
+
+  if (arr->heap == NULL) {
+    return arr;
+  }
+
+  low = 0;
+  high = LIST_GET_LEN(arr->base) - 1;
+
+  while (low < high) {
+    mid = (low + high + 1) / 2;
+    if (arr->index[mid]->offset <= pos) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+
+  return arr->index[low];
+}
+
 byte *dyn_array_open(dyn_array_t *arr, size_t size) {
   dyn_block_t *block;
 
   assert(arr);
-  assert(size <= DYN_ARRAY_DATA_SIZE);
   assert(size);
 
   block = arr;
 
-  if (block->used + size > DYN_ARRAY_DATA_SIZE) {
+  if (block->used + size > block->size) {
     block = dyn_array_get_last_block(arr);
-    if (block->used + size > DYN_ARRAY_DATA_SIZE) {
-      block = dyn_array_add_block(arr);
-      assert(size <= DYN_ARRAY_DATA_SIZE);
+    if (block->used + size > block->size) {
+      block = dyn_array_add_block(arr, size);
     }
   }
 
-  assert(block->used <= DYN_ARRAY_DATA_SIZE);
+  assert(block->used + size <= block->size);
 
   return block->data + block->used;
 }
@@ -77,7 +153,7 @@ void dyn_array_close(dyn_array_t *arr, const byte *ptr) {
 
   block->used = ptr - block->data;
 
-  assert(block->used <= DYN_ARRAY_DATA_SIZE);
+  assert(block->used <= block->size);
 }
 
 void *dyn_array_push(dyn_array_t *arr, size_t size) {
@@ -85,20 +161,21 @@ void *dyn_array_push(dyn_array_t *arr, size_t size) {
   size_t used;
 
   assert(arr);
-  assert(size <= DYN_ARRAY_DATA_SIZE);
   assert(size);
 
-  if (block->used + size > DYN_ARRAY_DATA_SIZE) {
+  block = arr;
+
+  if (block->used + size > block->size) {
     block = dyn_array_get_last_block(arr);
-    if (block->used + size > DYN_ARRAY_DATA_SIZE) {
-      block = dyn_array_add_block(arr);
+    if (block->used + size > block->size) {
+      block = dyn_array_add_block(arr, size);
     }
   }
 
   used = block->used;
 
   block->used = used + size;
-  assert(block->used <= DYN_ARRAY_DATA_SIZE);
+  assert(block->used <= block->size);
 
   return block->data + used;
 }
@@ -108,20 +185,10 @@ void *dyn_array_get_element(const dyn_array_t *arr, size_t pos) {
 
   assert(arr);
 
-  block = dyn_array_get_first_block(arr);
-
-  if (arr->heap != NULL) {
-    for (;;) {
-      size_t used = dyn_block_get_used(block);
-      if (pos < used)
-        break;
-      pos -= used;
-      block = LIST_GET_NEXT(list, block);
-      assert(block);
-    }
-  }
-
+  block = dyn_array_find_block(arr, pos);
   assert(block);
+
+  pos -= block->offset;
   assert(dyn_block_get_used(block) >= pos);
 
   return (byte *)block->data + pos;
@@ -129,21 +196,12 @@ void *dyn_array_get_element(const dyn_array_t *arr, size_t pos) {
 
 size_t dyn_array_get_data_size(const dyn_array_t *arr) {
   const dyn_block_t *block;
-  size_t sum = 0;
 
   assert(arr);
 
-  if (arr->heap == NULL)
-    return arr->used;
-
-  block = dyn_array_get_first_block(arr);
-
-  while (block != NULL) {
-    sum += dyn_block_get_used(block);
-    block = dyn_array_get_next_block(arr, block);
-  }
+  block = dyn_array_get_last_block(arr);
 
-  return sum;
+  return block->offset + dyn_block_get_used(block);
 }
 
 size_t dyn_block_get_used(const dyn_block_t *block) {
@@ -156,19 +214,169 @@ byte *dyn_block_get_data(dyn_block_t *block) {
   return (byte *)block->data;
 }
 
+// Fills the tail of the last block first, the rest goes to one new block.
 void dyn_push_string(dyn_array_t *arr, const char *str, size_t len) {
+  dyn_block_t *block;
   size_t n_copied;
 
+  assert(arr);
+  assert(str || !len);
+
   while (len > 0) {
-    if (len > DYN_ARRAY_DATA_SIZE) {
-      n_copied = DYN_ARRAY_DATA_SIZE;
-    } else {
-      n_copied = len;
+    block = dyn_array_get_last_block(arr);
+
+    if (block->used == block->size) {
+      block = dyn_array_add_block(arr, len);
     }
 
-    memcpy(dyn_array_push(arr, n_copied), str, n_copied);
+    n_copied = min(len, block->size - block->used);
+
+    memcpy(block->data + block->used, str, n_copied);
+    block->used += n_copied;
 
     str += n_copied;
     len -= n_copied;
   }
-}
\ No newline at end of file
+}
+
+void dyn_array_cursor_init(dyn_array_cursor_t *cur, const dyn_array_t *arr, size_t pos) {
+  assert(cur);
+  assert(arr);
+  assert(pos <= dyn_array_get_data_size(arr));
+
+  cur->arr = arr;
+  cur->block = dyn_array_find_block(arr, pos);
+  cur->pos = pos - cur->block->offset;
+}
+
+size_t dyn_array_cursor_next(dyn_array_cursor_t *cur, const byte **data) {
+  const dyn_block_t *block;
+  size_t len;
+
+  assert(cur);
+  assert(data);
+
+  block = cur->block;
+
+  for (;;) {
+    len = dyn_block_get_used(block) - cur->pos;
+
+    if (len > 0) {
+      *data = block->data + cur->pos;
+      cur->pos += len;
+      return len;
+    }
+
+    block = dyn_array_get_next_block(cur->arr, block);
+    if (block == NULL) {
+      return 0;
+    }
+
+    cur->block = block;
+    cur->pos = 0;
+  }
+}
+
+size_t dyn_array_cursor_read(dyn_array_cursor_t *cur, void *buf, size_t n) {
+  const dyn_block_t *block;
+  size_t copied = 0;
+  size_t len;
+
+  assert(cur);
+  assert(buf || !n);
+
+  block = cur->block;
+
+  while (copied < n && block != NULL) {
+    len = min(dyn_block_get_used(block) - cur->pos, n - copied);
+
+    memcpy((byte *)buf + copied, block->data + cur->pos, len);
+    copied += len;
+    cur->pos += len;
+
+    if (cur->pos == dyn_block_get_used(block)) {
+      block = dyn_array_get_next_block(cur->arr, block);
+      if (block != NULL) {
+        cur->block = block;
+        cur->pos = 0;
+      }
+    }
+  }
+
+  return copied;
+}
+
+size_t dyn_array_cursor_get_iovec(dyn_array_cursor_t *cur, struct iovec *iov, size_t n_iov) {
+  const byte *data;
+  size_t len;
+  size_t n = 0;
+
+  assert(cur);
+  assert(iov || !n_iov);
+
+  while (n < n_iov && (len = dyn_array_cursor_next(cur, &data)) > 0) {
+    iov[n].iov_base = (void *)data;
+    iov[n].iov_len = len;
+    n++;
+  }
+
+  return n;
+}
+
+size_t dyn_array_get_iovec(const dyn_array_t *arr, struct iovec *iov, size_t n_iov) {
+  dyn_array_cursor_t cur;
+
+  dyn_array_cursor_init(&cur, arr, 0);
+
+  return dyn_array_cursor_get_iovec(&cur, iov, n_iov);
+}
+
+// Writes the array from its start, at offset if it is not negative.
+static ssize_t dyn_array_write_low(const dyn_array_t *arr, int fd, off_t offset) {
+  struct iovec iov[DYN_ARRAY_IOV_BATCH];
+  dyn_array_cursor_t cur;
+  size_t size;
+  size_t pos = 0;
+  size_t n_iov;
+  ssize_t ret;
+
+  assert(arr);
+
+  size = dyn_array_get_data_size(arr);
+
+  while (pos < size) {
+    dyn_array_cursor_init(&cur, arr, pos);
+    n_iov = dyn_array_cursor_get_iovec(&cur, iov, DYN_ARRAY_IOV_BATCH);
+
+    if (offset < 0) {
+      ret = writev(fd, iov, (int)n_iov);
+    } else {
+      ret = pwritev(fd, iov, (int)n_iov, offset + (off_t)pos);
+    }
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // Like write(2), bytes already written are reported instead of the error.
+      return pos > 0 ? (ssize_t)pos : -1;
+    }
+
+    if (ret == 0) {
+      break;
+    }
+
+    pos += ret;
+  }
+
+  return (ssize_t)pos;
+}
+
+ssize_t dyn_array_write(const dyn_array_t *arr, int fd) {
+  return dyn_array_write_low(arr, fd, -1);
+}
+
+ssize_t dyn_array_pwrite(const dyn_array_t *arr, int fd, off_t offset) {
+  assert(offset >= 0);
+  return dyn_array_write_low(arr, fd, offset);
+}
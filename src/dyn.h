@@ -8,22 +8,48 @@
 #include "heap.h"
 #include "byte.h"
 #include "lst.h"
+#include <sys/types.h>
+#include <sys/uio.h>
 
+// Size of the data kept inline in the first block.
 #define	DYN_ARRAY_DATA_SIZE	512
+// Default cap of the geometric growth of the blocks added after the first.
+#define DYN_ARRAY_MAX_BLOCK_SIZE (64 * 1024)
 
+/* The data of the first block is its inline buf, the blocks added later are
+allocated from the heap with their data right after the header. */
 typedef struct dyn_block_t dyn_block_t;
 struct dyn_block_t {
     mem_heap_t *heap;
     size_t used;
-    byte data[DYN_ARRAY_DATA_SIZE];
+    size_t size;
+    size_t offset;
+    byte *data;
     LIST(dyn_block_t) base;
     LIST_NODE(dyn_block_t) list;
+    dyn_block_t **index;
+    size_t index_size;
+    size_t block_size;
+    size_t max_block_size;
+    byte buf[DYN_ARRAY_DATA_SIZE];
 };
 
 typedef dyn_block_t dyn_array_t;
 
+// Streams through the data of a dyn array block by block.
+typedef struct dyn_array_cursor_t dyn_array_cursor_t;
+struct dyn_array_cursor_t {
+    const dyn_array_t *arr;
+    const dyn_block_t *block;
+    size_t pos;
+};
+
 dyn_array_t *dyn_array_create(dyn_array_t *arr);
 
+/* Blocks added after the first start at block_size bytes and double up to
+max_block_size. A push larger than the next block gets a block of its own. */
+dyn_array_t *dyn_array_create_sized(dyn_array_t *arr, size_t block_size, size_t max_block_size);
+
 void dyn_array_free(dyn_array_t *arr);
 
 byte *dyn_array_open(dyn_array_t *arr, size_t size);
@@ -50,5 +76,28 @@ byte *dyn_block_get_data(dyn_block_t *block);
 
 void dyn_push_string(dyn_array_t *arr, const char *str, size_t len);
 
+void dyn_array_cursor_init(dyn_array_cursor_t *cur, const dyn_array_t *arr, size_t pos);
+
+// Returns the contiguous bytes from the cursor to the end of its block and moves past them, 0 at the end.
+size_t dyn_array_cursor_next(dyn_array_cursor_t *cur, const byte **data);
+
+// Copies up to n bytes from the cursor to buf, returns the number copied.
+size_t dyn_array_cursor_read(dyn_array_cursor_t *cur, void *buf, size_t n);
+
+// Describes up to n_iov blocks from the cursor on in iov and moves past them, returns the number filled.
+size_t dyn_array_cursor_get_iovec(dyn_array_cursor_t *cur, struct iovec *iov, size_t n_iov);
+
+// Describes up to n_iov blocks from the start of the array, without copying the data.
+size_t dyn_array_get_iovec(const dyn_array_t *arr, struct iovec *iov, size_t n_iov);
+
+/* Writes the whole array to fd with writev, resuming after partial writes and
+EINTR. Returns the number of bytes written, which is short if an error such
+as EAGAIN stops it after some bytes went out, or -1 with errno set if none
+did. The rest can be written from a cursor at the returned position. */
+ssize_t dyn_array_write(const dyn_array_t *arr, int fd);
+
+// Same as dyn_array_write, with pwritev starting at offset.
+ssize_t dyn_array_pwrite(const dyn_array_t *arr, int fd, off_t offset);
+
 
 #endif
\ No newline at end of file
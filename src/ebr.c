@@ -0,0 +1,256 @@
+/**
+ * @file ebr.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "ebr.h"
+#include "calc.h"
+#include "lst.h"
+#include "mutex.h"
+#include "pool.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#define EBR_RECLAIM_THRESHOLD 64
+#define EBR_ACTIVE 1
+
+typedef struct ebr_retired_t ebr_retired_t;
+struct ebr_retired_t {
+  void *ptr;
+  ebr_free_t free_func;
+  ebr_free_arg_t free_arg_func;
+  void *arg;
+  size_t epoch;
+  ebr_retired_t *next;
+};
+
+/* local is 0 outside a critical section, otherwise the epoch observed on
+entry shifted left by one with EBR_ACTIVE set. Only the owner writes it. */
+typedef struct ebr_thread_t ebr_thread_t;
+struct ebr_thread_t {
+  size_t local;
+  size_t depth;
+  LIST_NODE(ebr_thread_t) list;
+  mem_pool_t *pool;
+  ebr_retired_t *first;
+  ebr_retired_t *last;
+  size_t n_pending;
+  size_t n_since_reclaim;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+static size_t ebr_epoch __attribute__((aligned(CACHE_LINE_SIZE))) = 1;
+
+static mutex_t ebr_mutex;
+static LIST(ebr_thread_t) ebr_threads;
+static pthread_key_t ebr_key;
+static pthread_once_t ebr_once = PTHREAD_ONCE_INIT;
+
+static __thread ebr_thread_t *ebr_self = NULL;
+
+static void ebr_free_pending(ebr_thread_t *thr, size_t epoch) {
+  ebr_retired_t *retired;
+
+  while (thr->first != NULL && thr->first->epoch + 2 <= epoch) {
+    retired = thr->first;
+    thr->first = retired->next;
+
+    if (retired->free_arg_func != NULL) {
+      retired->free_arg_func(retired->ptr, retired->arg);
+    } else {
+      retired->free_func(retired->ptr);
+    }
+    mem_pool_release(thr->pool, retired);
+    thr->n_pending--;
+  }
+
+  if (thr->first == NULL) {
+    thr->last = NULL;
+  }
+}
+
+// Moves the epoch forward if every active thread has observed it.
+static void ebr_try_advance(void) {
+  ebr_thread_t *thr;
+  size_t epoch;
+  size_t local;
+
+  epoch = __atomic_load_n(&ebr_epoch, __ATOMIC_SEQ_CST);
+
+  mutex_lock(&ebr_mutex);
+  LIST_FOREACH(list, thr, ebr_threads) {
+    local = __atomic_load_n(&thr->local, __ATOMIC_SEQ_CST);
+    if ((local & EBR_ACTIVE) && (local >> 1) != epoch) {
+      mutex_unlock(&ebr_mutex);
+      return;
+    }
+  }
+  mutex_unlock(&ebr_mutex);
+
+  __atomic_compare_exchange_n(&ebr_epoch, &epoch, epoch + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static void ebr_wait_grace(ebr_thread_t *thr) {
+  size_t target;
+
+  target = __atomic_load_n(&ebr_epoch, __ATOMIC_SEQ_CST) + 2;
+
+  while (__atomic_load_n(&ebr_epoch, __ATOMIC_SEQ_CST) < target) {
+    ebr_try_advance();
+    sched_yield();
+  }
+
+  ebr_free_pending(thr, target);
+}
+
+// Unregisters an exiting thread after the nodes it retired are freed.
+static void ebr_destroy(void *arg) {
+  ebr_thread_t *thr = (ebr_thread_t *)arg;
+
+  assert(thr->depth == 0);
+
+  ebr_wait_grace(thr);
+  assert(thr->first == NULL);
+
+  mutex_lock(&ebr_mutex);
+  LIST_REMOVE(list, ebr_threads, thr);
+  mutex_unlock(&ebr_mutex);
+
+  mem_pool_free(thr->pool);
+  free(thr);
+}
+
+static void ebr_init(void) {
+  int ret;
+
+  mutex_init(&ebr_mutex);
+  LIST_INIT(ebr_threads);
+
+  ret = pthread_key_create(&ebr_key, ebr_destroy);
+  assert(ret == 0);
+}
+
+static ebr_thread_t *ebr_get_thread(void) {
+  ebr_thread_t *thr;
+  int ret;
+
+  if (ebr_self != NULL) {
+    return ebr_self;
+  }
+
+  pthread_once(&ebr_once, ebr_init);
+
+  thr = (ebr_thread_t *)aligned_alloc(CACHE_LINE_SIZE, sizeof(ebr_thread_t));
+  assert(thr);
+
+  thr->local = 0;
+  thr->depth = 0;
+  thr->pool = MEM_POOL_CREATE(ebr_retired_t, 0);
+  thr->first = NULL;
+  thr->last = NULL;
+  thr->n_pending = 0;
+  thr->n_since_reclaim = 0;
+
+  mutex_lock(&ebr_mutex);
+  LIST_ADD_LAST(list, ebr_threads, thr);
+  mutex_unlock(&ebr_mutex);
+
+  ret = pthread_setspecific(ebr_key, thr);
+  assert(ret == 0);
+
+  ebr_self = thr;
+
+  return thr;
+}
+
+void ebr_enter(void) {
+  ebr_thread_t *thr = ebr_get_thread();
+  size_t epoch;
+
+  if (thr->depth++ > 0) {
+    return;
+  }
+
+  epoch = __atomic_load_n(&ebr_epoch, __ATOMIC_RELAXED);
+  // a full barrier, the announcement must be visible before any shared pointer is read
+  __atomic_exchange_n(&thr->local, (epoch << 1) | EBR_ACTIVE, __ATOMIC_SEQ_CST);
+}
+
+void ebr_exit(void) {
+  ebr_thread_t *thr = ebr_self;
+
+  assert(thr != NULL && thr->depth > 0);
+
+  if (--thr->depth > 0) {
+    return;
+  }
+
+  __atomic_store_n(&thr->local, 0, __ATOMIC_RELEASE);
+}
+
+bool ebr_in_critical(void) {
+  return ebr_self != NULL && ebr_self->depth > 0;
+}
+
+static void ebr_retire_low(void *ptr, ebr_free_t free_func, ebr_free_arg_t free_arg_func, void *arg) {
+  ebr_thread_t *thr = ebr_get_thread();
+  ebr_retired_t *retired;
+
+  retired = MEM_POOL_ALLOC(ebr_retired_t, thr->pool);
+  retired->ptr = ptr;
+  retired->free_func = free_func;
+  retired->free_arg_func = free_arg_func;
+  retired->arg = arg;
+  // read after ptr was unlinked, readers of a later epoch cannot reach it
+  retired->epoch = __atomic_load_n(&ebr_epoch, __ATOMIC_SEQ_CST);
+  retired->next = NULL;
+
+  if (thr->last == NULL) {
+    thr->first = retired;
+  } else {
+    thr->last->next = retired;
+  }
+  thr->last = retired;
+  thr->n_pending++;
+
+  if (++thr->n_since_reclaim >= EBR_RECLAIM_THRESHOLD) {
+    ebr_reclaim();
+  }
+}
+
+void ebr_retire(void *ptr, ebr_free_t free_func) {
+  assert(free_func);
+  ebr_retire_low(ptr, free_func, NULL, NULL);
+}
+
+void ebr_retire_arg(void *ptr, ebr_free_arg_t free_func, void *arg) {
+  assert(free_func);
+  ebr_retire_low(ptr, NULL, free_func, arg);
+}
+
+void ebr_reclaim(void) {
+  ebr_thread_t *thr = ebr_get_thread();
+
+  thr->n_since_reclaim = 0;
+
+  ebr_try_advance();
+  ebr_free_pending(thr, __atomic_load_n(&ebr_epoch, __ATOMIC_SEQ_CST));
+}
+
+void ebr_synchronize(void) {
+  ebr_thread_t *thr = ebr_get_thread();
+
+  // waiting inside a critical section would wait for ourselves
+  assert(thr->depth == 0);
+
+  ebr_wait_grace(thr);
+}
+
+size_t ebr_get_epoch(void) {
+  return __atomic_load_n(&ebr_epoch, __ATOMIC_SEQ_CST);
+}
+
+size_t ebr_get_n_pending(void) {
+  return ebr_self == NULL ? 0 : ebr_self->n_pending;
+}
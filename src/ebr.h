@@ -0,0 +1,44 @@
+/**
+ * @file ebr.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef EBR_H
+#define EBR_H
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Epoch based reclamation. Readers traverse shared structures between
+ebr_enter and ebr_exit without taking locks, writers unlink a node and hand
+it to ebr_retire instead of freeing it. A retired node is freed once the
+global epoch has moved twice since, which can only happen after every reader
+that might still see it has left its critical section. */
+typedef void (*ebr_free_t)(void *ptr);
+
+typedef void (*ebr_free_arg_t)(void *ptr, void *arg);
+
+// Critical sections nest, only the outermost pair publishes the epoch.
+void ebr_enter(void);
+
+void ebr_exit(void);
+
+bool ebr_in_critical(void);
+
+// Frees ptr with free_func after a grace period, ptr must already be unreachable.
+void ebr_retire(void *ptr, ebr_free_t free_func);
+
+// Same as ebr_retire, free_func also gets arg, e.g. the structure ptr goes back to.
+void ebr_retire_arg(void *ptr, ebr_free_arg_t free_func, void *arg);
+
+// Tries to move the epoch and frees what this thread retired and is now safe.
+void ebr_reclaim(void);
+
+// Waits for a full grace period and frees everything this thread retired.
+void ebr_synchronize(void);
+
+size_t ebr_get_epoch(void);
+
+// Nodes retired by this thread and not yet freed.
+size_t ebr_get_n_pending(void);
+
+#endif
@@ -7,6 +7,8 @@
 #define HASH_H
 #include "calc.h"
 #include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -17,49 +19,182 @@ struct hash_cell_t {
   void *node;
 };
 
+// Returns the fold of a node, used to move nodes when a table grows.
+typedef size_t (*hash_fold_t)(const void *node);
+
+/* A resizable table doubles its cells when it holds more nodes than cells.
+The nodes of the old array are then moved a few cells at a time by later
+inserts and searches. Cells of the old array below migrate_pos have been
+moved; a fold whose old cell is at or past migrate_pos still lives there. */
 typedef struct hash_table_t hash_table_t;
 struct hash_table_t {
   size_t n_cells;
   hash_cell_t *array;
+  size_t type;
+  uint64_t magic;
+  size_t n_nodes;
+  hash_fold_t fold;
+  size_t link_offset;
+  size_t old_n_cells;
+  uint64_t old_magic;
+  hash_cell_t *old_array;
+  size_t migrate_pos;
+  size_t n_sampled;
+  size_t n_probes;
 };
 
+/* A prime table reduces the fold modulo a prime with a precomputed
+reciprocal instead of a divide, a power of two table mixes the fold with a
+finalizer and masks it. */
+#define HASH_TABLE_PRIME 0
+#define HASH_TABLE_POW2 1
+
+#define HASH_MAX_LOAD 1
+#define HASH_MIGRATE_BATCH 8
+
+// HASH_SEARCH counts the nodes it visits on one search out of this many, a power of two.
+#define HASH_PROBE_SAMPLE 64
+
+/* Picks the searches to sample with a random draw of the calling thread, so
+an unsampled search does not write to the table and tables searched under a
+shared lock stay read-only. A draw, unlike a counter, does not alias with
+searches that alternate between tables. */
+static inline bool hash_search_sampled(void) {
+  static __thread uint64_t seed;
+
+  if (seed == 0) {
+    seed = (uintptr_t)&seed | 1;
+  }
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+
+  return (seed & (HASH_PROBE_SAMPLE - 1)) == 0;
+}
+
 static inline void hash_table_clear(hash_table_t *table) {
   assert(table);
   memset(table->array, 0x0, table->n_cells * sizeof(*table->array));
+  free(table->old_array);
+  table->old_array = NULL;
+  table->old_n_cells = 0;
+  table->migrate_pos = 0;
+  table->n_nodes = 0;
+  table->n_sampled = 0;
+  table->n_probes = 0;
 }
 
-static inline hash_table_t *hash_create(size_t n) {
+// Reciprocal of n for hash_calc_hash_low, n must fit in 32 bits.
+static inline uint64_t hash_calc_magic(size_t n, size_t type) {
+  if (type == HASH_TABLE_POW2) {
+    return 0;
+  }
+  assert(n > 0 && n <= UINT32_MAX);
+  return UINT64_MAX / n + 1;
+}
+
+static inline size_t hash_calc_n_cells(size_t n, size_t type) {
+  if (type == HASH_TABLE_POW2) {
+    return calc_2_power_up(max(n, 1));
+  }
+  return calc_find_prime(n);
+}
+
+static inline hash_table_t *hash_create_typed(size_t n, size_t type) {
   hash_cell_t *array;
-  size_t prime;
+  size_t n_cells;
   hash_table_t *table;
 
-  prime = calc_find_prime(n);
+  assert(type == HASH_TABLE_PRIME || type == HASH_TABLE_POW2);
+
+  n_cells = hash_calc_n_cells(n, type);
 
-  table = (hash_table_t *)malloc(sizeof(hash_cell_t));
+  table = (hash_table_t *)malloc(sizeof(hash_table_t));
   assert(table);
 
-  array = (hash_cell_t *)malloc(sizeof(hash_cell_t) * prime);
+  array = (hash_cell_t *)malloc(sizeof(hash_cell_t) * n_cells);
   assert(array);
 
   table->array = array;
-  table->n_cells = prime;
+  table->n_cells = n_cells;
+  table->type = type;
+  table->magic = hash_calc_magic(n_cells, type);
+  table->fold = NULL;
+  table->link_offset = 0;
+  table->old_array = NULL;
 
   hash_table_clear(table);
 
   return table;
 }
 
+static inline hash_table_t *hash_create(size_t n) {
+  return hash_create_typed(n, HASH_TABLE_PRIME);
+}
+
+/* Creates a table that grows by itself. fold must return the same fold the
+node was inserted with, link_offset is the offset of the chain pointer. */
+static inline hash_table_t *hash_create_resizable(size_t n, size_t type, hash_fold_t fold, size_t link_offset) {
+  hash_table_t *table;
+
+  assert(fold);
+
+  table = hash_create_typed(n, type);
+  table->fold = fold;
+  table->link_offset = link_offset;
+
+  return table;
+}
+
+#define HASH_CREATE_RESIZABLE(TYPE, NAME, N, TABLE_TYPE, FOLD_FUNC) \
+  hash_create_resizable((N), (TABLE_TYPE), (FOLD_FUNC), offsetof(TYPE, NAME))
+
 static inline void hash_table_free(hash_table_t *table) {
   assert(table);
+  free(table->old_array);
   free(table->array);
   free(table);
 }
 
+static inline size_t hash_get_n_cells(hash_table_t *table) {
+  assert(table);
+  return table->n_cells;
+}
+
 #define HASH_RANDOM_MASK2 1653893711
+
+// Finalizer of murmur3, every bit of the fold affects the low bits.
+static inline uint64_t hash_mix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/* The prime reduction folds the fold to 32 bits and computes the remainder
+from the fractional part of fold * magic, see Lemire's fastmod. */
+static inline size_t hash_calc_hash_low(size_t fold, size_t n_cells, uint64_t magic, size_t type) {
+  uint64_t h = (uint64_t)fold;
+  uint32_t low;
+
+  if (type == HASH_TABLE_POW2) {
+    return (size_t)(hash_mix64(h) & (n_cells - 1));
+  }
+
+  h ^= HASH_RANDOM_MASK2;
+  low = (uint32_t)(h ^ (h >> 32));
+#ifdef __SIZEOF_INT128__
+  return (size_t)(((__uint128_t)(magic * low) * n_cells) >> 64);
+#else
+  return low % n_cells;
+#endif
+}
+
 static inline size_t hash_calc_hash(size_t fold, hash_table_t *table) {
   assert(table);
-  fold = fold ^ HASH_RANDOM_MASK2;
-  return fold % table->n_cells;
+  return hash_calc_hash_low(fold, table->n_cells, table->magic, table->type);
 }
 
 static inline hash_cell_t *hash_get_nth_cell(hash_table_t *table, size_t n) {
@@ -68,62 +203,179 @@ static inline hash_cell_t *hash_get_nth_cell(hash_table_t *table, size_t n) {
   return (table->array + n);
 }
 
+// Returns the cell that holds the chain of fold, in the old array while it has not been moved.
+static inline hash_cell_t *hash_get_cell(hash_table_t *table, size_t fold) {
+  size_t n;
+
+  assert(table);
+
+  if (table->old_array != NULL) {
+    n = hash_calc_hash_low(fold, table->old_n_cells, table->old_magic, table->type);
+    if (n >= table->migrate_pos) {
+      return table->old_array + n;
+    }
+  }
+
+  return hash_get_nth_cell(table, hash_calc_hash(fold, table));
+}
+
+// Cells of the array and, during a resize, of the old array.
+static inline size_t hash_get_n_cells_all(hash_table_t *table) {
+  assert(table);
+  return table->n_cells + (table->old_array != NULL ? table->old_n_cells : 0);
+}
+
+static inline hash_cell_t *hash_get_nth_cell_all(hash_table_t *table, size_t n) {
+  assert(n < hash_get_n_cells_all(table));
+  if (n < table->n_cells) {
+    return table->array + n;
+  }
+  return table->old_array + (n - table->n_cells);
+}
+
+#define hash_node_next(TABLE, NODE) (*(void **)((char *)(NODE) + (TABLE)->link_offset))
+
+// Moves the nodes of up to HASH_MIGRATE_BATCH old cells, keeping their chain order.
+static inline void hash_migrate_step(hash_table_t *table) {
+  size_t end;
+  void *node;
+  void *next;
+  void **link;
+
+  if (table->old_array == NULL) {
+    return;
+  }
+
+  end = min(table->migrate_pos + HASH_MIGRATE_BATCH, table->old_n_cells);
+
+  for (; table->migrate_pos < end; table->migrate_pos++) {
+    node = table->old_array[table->migrate_pos].node;
+    table->old_array[table->migrate_pos].node = NULL;
+
+    while (node != NULL) {
+      next = hash_node_next(table, node);
+
+      link = &hash_get_nth_cell(table, hash_calc_hash(table->fold(node), table))->node;
+      while (*link != NULL) {
+        link = &hash_node_next(table, *link);
+      }
+      *link = node;
+      hash_node_next(table, node) = NULL;
+
+      node = next;
+    }
+  }
+
+  if (table->migrate_pos == table->old_n_cells) {
+    free(table->old_array);
+    table->old_array = NULL;
+  }
+}
+
+static inline void hash_resize_start(hash_table_t *table) {
+  hash_cell_t *array;
+  size_t n_cells;
+
+  assert(table->old_array == NULL);
+
+  n_cells = hash_calc_n_cells(2 * table->n_cells, table->type);
+
+  array = (hash_cell_t *)calloc(n_cells, sizeof(hash_cell_t));
+  assert(array);
+
+  table->old_array = table->array;
+  table->old_n_cells = table->n_cells;
+  table->old_magic = table->magic;
+  table->migrate_pos = 0;
+  table->array = array;
+  table->n_cells = n_cells;
+  table->magic = hash_calc_magic(n_cells, table->type);
+}
+
+static inline void hash_node_inserted(hash_table_t *table) {
+  table->n_nodes++;
+
+  if (table->fold == NULL) {
+    return;
+  }
+
+  if (table->old_array != NULL) {
+    hash_migrate_step(table);
+  } else if (table->n_nodes > HASH_MAX_LOAD * table->n_cells) {
+    hash_resize_start(table);
+  }
+}
+
 #define HASH_ASSERT_VALID(DATA) assert((void *)(DATA) != (void *)-1)
-#define HASH_INVALIDATE(DATA, NAME) *(void **)(&DATA->NAME) = (void *)-1
-
-#define HASH_INSERT(TYPE, NAME, TABLE, FOLD, DATA)                    \
-  do {                                                                \
-    hash_cell_t *cell3333;                                            \
-    TYPE *struct3333;                                                 \
-                                                                      \
-    (DATA)->NAME = NULL;                                              \
-                                                                      \
-    cell3333 = hash_get_nth_cell(TABLE, hash_calc_hash(FOLD, TABLE)); \
-                                                                      \
-    if (cell3333->node == NULL) {                                     \
-      cell3333->node = DATA;                                          \
-    } else {                                                          \
-      struct3333 = (TYPE *)cell3333->node;                            \
-                                                                      \
-      while (struct3333->NAME != NULL) {                              \
-                                                                      \
-        struct3333 = (TYPE *)struct3333->NAME;                        \
-      }                                                               \
-                                                                      \
-      struct3333->NAME = DATA;                                        \
-    }                                                                 \
+#define HASH_INVALIDATE(DATA, NAME) *(void **)(&(DATA)->NAME) = (void *)-1
+
+#define HASH_INSERT(TYPE, NAME, TABLE, FOLD, DATA)     \
+  do {                                                 \
+    hash_cell_t *cell3333;                             \
+    TYPE *struct3333;                                  \
+                                                       \
+    (DATA)->NAME = NULL;                               \
+                                                       \
+    cell3333 = hash_get_cell(TABLE, FOLD);             \
+                                                       \
+    if (cell3333->node == NULL) {                      \
+      cell3333->node = DATA;                           \
+    } else {                                           \
+      struct3333 = (TYPE *)cell3333->node;             \
+                                                       \
+      while (struct3333->NAME != NULL) {               \
+                                                       \
+        struct3333 = (TYPE *)struct3333->NAME;         \
+      }                                                \
+                                                       \
+      struct3333->NAME = DATA;                         \
+    }                                                  \
+                                                       \
+    hash_node_inserted(TABLE);                         \
   } while (0)
 
-#define HASH_DELETE(TYPE, NAME, TABLE, FOLD, DATA)                    \
-  do {                                                                \
-    hash_cell_t *cell3333;                                            \
-    TYPE *struct3333;                                                 \
-                                                                      \
-    cell3333 = hash_get_nth_cell(TABLE, hash_calc_hash(FOLD, TABLE)); \
-                                                                      \
-    if (cell3333->node == DATA) {                                     \
-      cell3333->node = DATA->NAME;                                    \
-    } else {                                                          \
-      struct3333 = (TYPE *)cell3333->node;                            \
-                                                                      \
-      while (struct3333->NAME != DATA) {                              \
-                                                                      \
-        struct3333 = (TYPE *)struct3333->NAME;                        \
-        assert(struct3333);                                           \
-      }                                                               \
-                                                                      \
-      struct3333->NAME = DATA->NAME;                                  \
-    }                                                                 \
-    HASH_INVALIDATE(DATA, NAME);                                      \
+#define HASH_DELETE(TYPE, NAME, TABLE, FOLD, DATA)     \
+  do {                                                 \
+    hash_cell_t *cell3333;                             \
+    TYPE *struct3333;                                  \
+                                                       \
+    cell3333 = hash_get_cell(TABLE, FOLD);             \
+                                                       \
+    if (cell3333->node == DATA) {                      \
+      cell3333->node = (DATA)->NAME;                   \
+    } else {                                           \
+      struct3333 = (TYPE *)cell3333->node;             \
+                                                       \
+      while (struct3333->NAME != DATA) {               \
+                                                       \
+        struct3333 = (TYPE *)struct3333->NAME;         \
+        assert(struct3333);                            \
+      }                                                \
+                                                       \
+      struct3333->NAME = (DATA)->NAME;                 \
+    }                                                  \
+    HASH_INVALIDATE(DATA, NAME);                       \
+    (TABLE)->n_nodes--;                                \
   } while (0)
 
-#define HASH_GET_FIRST(TABLE, HASH_VAL) (hash_get_nth_cell(TABLE, HASH_VAL)->node)
+/* HASH_VAL is a cell number from hash_calc_hash, which only sees the new
+array of a growing table, so a resizable table must use HASH_GET_FIRST_FOLD. */
+static inline void *hash_get_first(hash_table_t *table, size_t n) {
+  assert(table->fold == NULL);
+  return hash_get_nth_cell(table, n)->node;
+}
+
+#define HASH_GET_FIRST(TABLE, HASH_VAL) hash_get_first(TABLE, HASH_VAL)
+
+#define HASH_GET_FIRST_FOLD(TABLE, FOLD) (hash_get_cell(TABLE, FOLD)->node)
 
 #define HASH_GET_NEXT(NAME, DATA) ((DATA)->NAME)
 
-#define HASH_SEARCH(NAME, TABLE, FOLD, TYPE, DATA, ASSERTION, TEST)    \
+/* Same as HASH_SEARCH but never moves nodes of a growing table, so it only
+reads the table and may run concurrently with other readers. */
+#define HASH_SEARCH_LOW(NAME, TABLE, FOLD, TYPE, DATA, ASSERTION, TEST) \
   {                                                                    \
-    (DATA) = (TYPE)HASH_GET_FIRST(TABLE, hash_calc_hash(FOLD, TABLE)); \
+    (DATA) = (TYPE)hash_get_cell(TABLE, FOLD)->node;                   \
     HASH_ASSERT_VALID(DATA);                                           \
                                                                        \
     while ((DATA) != NULL) {                                           \
@@ -137,12 +389,37 @@ static inline hash_cell_t *hash_get_nth_cell(hash_table_t *table, size_t n) {
     }                                                                  \
   }
 
+/* A sampled search walks the chain again up to the node found to count
+the probes, so TEST is not evaluated twice. */
+#define HASH_SEARCH(NAME, TABLE, FOLD, TYPE, DATA, ASSERTION, TEST)      \
+  {                                                                      \
+    size_t fold3333 = (FOLD);                                            \
+                                                                         \
+    hash_migrate_step(TABLE);                                            \
+    HASH_SEARCH_LOW(NAME, TABLE, fold3333, TYPE, DATA, ASSERTION, TEST); \
+                                                                         \
+    if (hash_search_sampled()) {                                         \
+      TYPE probe3333 = (TYPE)hash_get_cell(TABLE, fold3333)->node;       \
+      size_t n3333 = 0;                                                  \
+                                                                         \
+      while (probe3333 != NULL) {                                        \
+        n3333++;                                                         \
+        if (probe3333 == (DATA)) {                                       \
+          break;                                                         \
+        }                                                                \
+        probe3333 = (TYPE)HASH_GET_NEXT(NAME, probe3333);                \
+      }                                                                  \
+      __atomic_fetch_add(&(TABLE)->n_sampled, 1, __ATOMIC_RELAXED);      \
+      __atomic_fetch_add(&(TABLE)->n_probes, n3333, __ATOMIC_RELAXED);   \
+    }                                                                    \
+  }
+
 #define HASH_SEARCH_ALL(NAME, TABLE, TYPE, DATA, ASSERTION, TEST) \
   do {                                                            \
     size_t i3333;                                                 \
                                                                   \
-    for (i3333 = (TABLE)->n_cells; i3333--;) {                    \
-      (DATA) = (TYPE)HASH_GET_FIRST(TABLE, i3333);                \
+    for (i3333 = hash_get_n_cells_all(TABLE); i3333--;) {         \
+      (DATA) = (TYPE)hash_get_nth_cell_all(TABLE, i3333)->node;   \
                                                                   \
       while ((DATA) != NULL) {                                    \
         HASH_ASSERT_VALID(DATA);                                  \
@@ -161,15 +438,246 @@ static inline hash_cell_t *hash_get_nth_cell(hash_table_t *table, size_t n) {
     }                                                             \
   } while (0)
 
+#define HASH_STAT_HIST_SIZE 8
+
+/* hist[i] counts the cells with a chain of i nodes, the last slot also the
+longer ones. avg_probes is the mean number of nodes visited by the sampled
+searches, hits and misses alike. n_searches is estimated from the samples. */
+typedef struct hash_table_stat_t hash_table_stat_t;
+struct hash_table_stat_t {
+  size_t n_cells;
+  size_t n_nodes;
+  size_t n_filled;
+  double load_factor;
+  size_t max_chain;
+  size_t hist[HASH_STAT_HIST_SIZE];
+  size_t n_searches;
+  size_t n_sampled;
+  double avg_probes;
+};
+
+// Walks every chain, link_offset is the offset of the chain pointer in a node.
+static inline void hash_table_get_stat(hash_table_t *table, size_t link_offset, hash_table_stat_t *stat) {
+  size_t i;
+  size_t len;
+  void *node;
+
+  assert(table);
+  assert(stat);
+
+  memset(stat, 0x0, sizeof(*stat));
+
+  for (i = 0; i < hash_get_n_cells_all(table); i++) {
+    len = 0;
+    for (node = hash_get_nth_cell_all(table, i)->node; node != NULL;
+         node = *(void **)((char *)node + link_offset)) {
+      len++;
+    }
+    stat->n_nodes += len;
+    stat->n_filled += len > 0;
+    stat->max_chain = max(stat->max_chain, len);
+    stat->hist[min(len, HASH_STAT_HIST_SIZE - 1)]++;
+  }
+
+  // during a resize hist also has the old cells not yet moved, the moved ones are empty
+  if (table->old_array != NULL) {
+    stat->hist[0] -= table->migrate_pos;
+  }
+  stat->n_cells = table->n_cells;
+  stat->load_factor = (double)stat->n_nodes / table->n_cells;
+  stat->n_sampled = __atomic_load_n(&table->n_sampled, __ATOMIC_RELAXED);
+  stat->n_searches = stat->n_sampled * HASH_PROBE_SAMPLE;
+  stat->avg_probes =
+      stat->n_sampled ? (double)__atomic_load_n(&table->n_probes, __ATOMIC_RELAXED) / stat->n_sampled : 0.0;
+}
+
+#define HASH_TABLE_GET_STAT(TYPE, NAME, TABLE, STAT) hash_table_get_stat((TABLE), offsetof(TYPE, NAME), (STAT))
+
+static inline void hash_table_print_stat(hash_table_t *table, size_t link_offset, FILE *file) {
+  hash_table_stat_t stat;
+  size_t i;
+
+  assert(file);
+
+  hash_table_get_stat(table, link_offset, &stat);
+
+  fprintf(file,
+          "hash table %p: cells %zu, nodes %zu, filled %zu, load %.2f, max chain %zu, "
+          "searches %zu, avg probes %.2f\n",
+          (void *)table, stat.n_cells, stat.n_nodes, stat.n_filled, stat.load_factor, stat.max_chain,
+          stat.n_searches, stat.avg_probes);
+
+  fprintf(file, "  chains:");
+  for (i = 0; i < HASH_STAT_HIST_SIZE; i++) {
+    if (stat.hist[i] != 0) {
+      fprintf(file, " %zu%s:%zu", i, i == HASH_STAT_HIST_SIZE - 1 ? "+" : "", stat.hist[i]);
+    }
+  }
+  fprintf(file, "\n");
+}
+
+// Returns true if node holds key, used by hash_search_batch.
+typedef bool (*hash_match_t)(const void *node, const void *key);
+
+#define HASH_BATCH_GROUP 16
+
+// Walks the chains whose heads are in out[begin, end), for hash_search_batch.
+static inline size_t hash_batch_walk(size_t link_offset, size_t begin, size_t end, const void *const *keys,
+                                     hash_match_t match, void **out) {
+  size_t n_found = 0;
+  size_t i;
+  void *node;
+
+  for (i = begin; i < end; i++) {
+    node = out[i];
+    while (node != NULL && !match(node, keys[i])) {
+      node = *(void **)((char *)node + link_offset);
+    }
+    out[i] = node;
+    n_found += node != NULL;
+  }
+
+  return n_found;
+}
+
+/* Looks up n keys, out[i] is the first node of the chain of folds[i] that
+matches keys[i], or NULL. Keys are handled in groups as a pipeline: while
+the chain heads of one group are loaded and prefetched, the cells of the
+next group are prefetched and the chains of the previous group are walked,
+so each prefetch has a group of work to complete behind. Like
+HASH_SEARCH_LOW it never moves nodes. Returns the number of keys found. */
+static inline size_t hash_search_batch(hash_table_t *table, size_t link_offset, size_t n, const size_t *folds,
+                                       const void *const *keys, hash_match_t match, void **out) {
+  hash_cell_t *cells[2][HASH_BATCH_GROUP];
+  size_t n_found = 0;
+  size_t prev = 0;
+  size_t begin;
+  size_t end;
+  size_t i;
+
+  assert(table);
+  assert(match);
+
+  for (i = 0; i < min(n, HASH_BATCH_GROUP); i++) {
+    cells[0][i] = hash_get_cell(table, folds[i]);
+    __builtin_prefetch(cells[0][i]);
+  }
+
+  for (begin = 0; begin < n; begin = end) {
+    size_t g = (begin / HASH_BATCH_GROUP) & 1;
+
+    end = min(begin + HASH_BATCH_GROUP, n);
+
+    for (i = begin; i < end; i++) {
+      out[i] = cells[g][i - begin]->node;
+      if (out[i] != NULL) {
+        __builtin_prefetch(out[i]);
+      }
+    }
+
+    for (i = end; i < min(end + HASH_BATCH_GROUP, n); i++) {
+      cells[g ^ 1][i - end] = hash_get_cell(table, folds[i]);
+      __builtin_prefetch(cells[g ^ 1][i - end]);
+    }
+
+    n_found += hash_batch_walk(link_offset, prev, begin, keys, match, out);
+    prev = begin;
+  }
+
+  n_found += hash_batch_walk(link_offset, prev, n, keys, match, out);
+
+  return n_found;
+}
+
+#define HASH_SEARCH_BATCH(TYPE, NAME, TABLE, N, FOLDS, KEYS, MATCH, OUT) \
+  hash_search_batch((TABLE), offsetof(TYPE, NAME), (N), (FOLDS), (KEYS), (MATCH), (void **)(OUT))
+
+/* Lock free readers. HASH_SEARCH_LF takes no lock and may run while one
+writer, serialized by the caller, uses HASH_INSERT_LF and HASH_DELETE_LF.
+Nodes are published with release stores and followed with acquire loads.
+A deleted node keeps its next pointer for readers still on it and must be
+freed only after a grace period, see ebr.h. Tables read this way must not
+be resizable since a reader cannot follow a node moved to another chain. */
+#define HASH_INSERT_LF(TYPE, NAME, TABLE, FOLD, DATA)                \
+  do {                                                               \
+    hash_cell_t *cell3333;                                           \
+    TYPE *struct3333;                                                \
+                                                                     \
+    assert((TABLE)->fold == NULL);                                   \
+                                                                     \
+    (DATA)->NAME = NULL;                                             \
+                                                                     \
+    cell3333 = hash_get_cell(TABLE, FOLD);                           \
+                                                                     \
+    if (cell3333->node == NULL) {                                    \
+      __atomic_store_n(&cell3333->node, (void *)(DATA),              \
+                       __ATOMIC_RELEASE);                            \
+    } else {                                                         \
+      struct3333 = (TYPE *)cell3333->node;                           \
+                                                                     \
+      while (struct3333->NAME != NULL) {                             \
+                                                                     \
+        struct3333 = (TYPE *)struct3333->NAME;                       \
+      }                                                              \
+                                                                     \
+      __atomic_store_n(&struct3333->NAME, (void *)(DATA),            \
+                       __ATOMIC_RELEASE);                            \
+    }                                                                \
+                                                                     \
+    (TABLE)->n_nodes++;                                              \
+  } while (0)
+
+#define HASH_DELETE_LF(TYPE, NAME, TABLE, FOLD, DATA)                \
+  do {                                                               \
+    hash_cell_t *cell3333;                                           \
+    TYPE *struct3333;                                                \
+                                                                     \
+    cell3333 = hash_get_cell(TABLE, FOLD);                           \
+                                                                     \
+    if (cell3333->node == (DATA)) {                                  \
+      __atomic_store_n(&cell3333->node, (DATA)->NAME,                \
+                       __ATOMIC_RELEASE);                            \
+    } else {                                                         \
+      struct3333 = (TYPE *)cell3333->node;                           \
+                                                                     \
+      while (struct3333->NAME != (DATA)) {                           \
+                                                                     \
+        struct3333 = (TYPE *)struct3333->NAME;                       \
+        assert(struct3333);                                          \
+      }                                                              \
+                                                                     \
+      __atomic_store_n(&struct3333->NAME, (DATA)->NAME,              \
+                       __ATOMIC_RELEASE);                            \
+    }                                                                \
+                                                                     \
+    (TABLE)->n_nodes--;                                              \
+  } while (0)
+
+#define HASH_SEARCH_LF(NAME, TABLE, FOLD, TYPE, DATA, ASSERTION, TEST)  \
+  {                                                                     \
+    (DATA) = (TYPE)__atomic_load_n(&hash_get_cell(TABLE, FOLD)->node,   \
+                                   __ATOMIC_ACQUIRE);                   \
+                                                                        \
+    while ((DATA) != NULL) {                                            \
+      ASSERTION;                                                        \
+      if (TEST) {                                                       \
+        break;                                                          \
+      }                                                                 \
+      (DATA) = (TYPE)__atomic_load_n(&HASH_GET_NEXT(NAME, DATA),        \
+                                     __ATOMIC_ACQUIRE);                 \
+    }                                                                   \
+  }
+
 #define HASH_MIGRATE(OLD_TABLE, NEW_TABLE, NODE_TYPE, PTR_NAME, FOLD_FUNC) \
   do {                                                                     \
     size_t i2222;                                                          \
     size_t cell_count2222;                                                 \
                                                                            \
-    cell_count2222 = hash_get_n_cells(OLD_TABLE);                          \
+    cell_count2222 = hash_get_n_cells_all(OLD_TABLE);                      \
                                                                            \
     for (i2222 = 0; i2222 < cell_count2222; i2222++) {                     \
-      NODE_TYPE *node2222 = HASH_GET_FIRST((OLD_TABLE), i2222);            \
+      NODE_TYPE *node2222 = (NODE_TYPE *)                                  \
+          hash_get_nth_cell_all((OLD_TABLE), i2222)->node;                 \
                                                                            \
       while (node2222) {                                                   \
         NODE_TYPE *next2222 = node2222->PTR_NAME;                          \
@@ -0,0 +1,116 @@
+/**
+ * @file hash_part.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "hash_part.h"
+#include <errno.h>
+
+static hash_part_table_t *hash_part_create_low(size_t n, size_t n_parts) {
+  hash_part_table_t *table;
+  size_t i;
+
+  n_parts = calc_2_power_up(max(n_parts, 1));
+
+  table = (hash_part_table_t *)malloc(sizeof(hash_part_table_t));
+  assert(table);
+
+  table->parts = (hash_part_t *)aligned_alloc(CACHE_LINE_SIZE, n_parts * sizeof(hash_part_t));
+  assert(table->parts);
+  table->n_parts = n_parts;
+
+  for (i = 0; i < n_parts; i++) {
+    hash_part_t *part = table->parts + i;
+
+    rwlock_init(&part->lock);
+    part->table = hash_create(n / n_parts + 1);
+    part->n_reads = 0;
+    part->n_writes = 0;
+    part->n_read_waits = 0;
+    part->n_write_waits = 0;
+  }
+
+  return table;
+}
+
+hash_part_table_t *hash_part_create(size_t n, size_t n_parts) {
+  return hash_part_create_low(n, n_parts);
+}
+
+hash_part_table_t *hash_part_create_resizable(size_t n, size_t n_parts, hash_fold_t fold, size_t link_offset) {
+  hash_part_table_t *table;
+  size_t i;
+
+  assert(fold);
+
+  table = hash_part_create_low(n, n_parts);
+
+  for (i = 0; i < table->n_parts; i++) {
+    table->parts[i].table->fold = fold;
+    table->parts[i].table->link_offset = link_offset;
+  }
+
+  return table;
+}
+
+void hash_part_free(hash_part_table_t *table) {
+  size_t i;
+
+  assert(table);
+
+  for (i = 0; i < table->n_parts; i++) {
+    rwlock_destroy(&table->parts[i].lock);
+    hash_table_free(table->parts[i].table);
+  }
+
+  free(table->parts);
+  free(table);
+}
+
+void hash_part_s_lock(hash_part_t *part) {
+  if (rwlock_tryrdlock(&part->lock) == EBUSY) {
+    __atomic_fetch_add(&part->n_read_waits, 1, __ATOMIC_RELAXED);
+    rwlock_rdlock(&part->lock);
+  }
+  // readers share the lock, so the counter is still updated atomically
+  __atomic_fetch_add(&part->n_reads, 1, __ATOMIC_RELAXED);
+}
+
+void hash_part_x_lock(hash_part_t *part) {
+  if (rwlock_trywrlock(&part->lock) == EBUSY) {
+    __atomic_fetch_add(&part->n_write_waits, 1, __ATOMIC_RELAXED);
+    rwlock_wrlock(&part->lock);
+  }
+  part->n_writes++;
+}
+
+void hash_part_unlock(hash_part_t *part) {
+  rwlock_unlock(&part->lock);
+}
+
+void hash_part_get_stat(hash_part_table_t *table, size_t i, hash_part_stat_t *stat) {
+  size_t begin;
+  size_t end;
+
+  assert(table);
+  assert(i <= table->n_parts);
+
+  begin = i == table->n_parts ? 0 : i;
+  end = i == table->n_parts ? table->n_parts : i + 1;
+
+  memset(stat, 0x0, sizeof(*stat));
+
+  for (i = begin; i < end; i++) {
+    hash_part_t *part = table->parts + i;
+
+    // not counted as a read
+    rwlock_rdlock(&part->lock);
+    stat->n_nodes += part->table->n_nodes;
+    stat->n_writes += part->n_writes;
+    rwlock_unlock(&part->lock);
+
+    stat->n_reads += __atomic_load_n(&part->n_reads, __ATOMIC_RELAXED);
+    stat->n_read_waits += __atomic_load_n(&part->n_read_waits, __ATOMIC_RELAXED);
+    stat->n_write_waits += __atomic_load_n(&part->n_write_waits, __ATOMIC_RELAXED);
+  }
+}
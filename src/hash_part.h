@@ -0,0 +1,95 @@
+/**
+ * @file hash_part.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef HASH_PART_H
+#define HASH_PART_H
+#include "hash.h"
+#include "rwlock.h"
+
+/* A hash table split into partitions, each an independent hash_table_t
+guarded by its own rwlock on its own cache line. The partition of a node is
+picked from the high bits of its fold so that the cells inside a partition
+still use the whole fold. Locks are tried first, a failed try is counted as
+a wait before blocking. */
+typedef struct hash_part_t hash_part_t;
+struct hash_part_t {
+    rwlock_t lock;
+    hash_table_t *table;
+    size_t n_reads;
+    size_t n_writes;
+    size_t n_read_waits;
+    size_t n_write_waits;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+typedef struct hash_part_table_t hash_part_table_t;
+struct hash_part_table_t {
+    size_t n_parts;
+    hash_part_t *parts;
+};
+
+typedef struct hash_part_stat_t hash_part_stat_t;
+struct hash_part_stat_t {
+    size_t n_nodes;
+    size_t n_reads;
+    size_t n_writes;
+    size_t n_read_waits;
+    size_t n_write_waits;
+};
+
+// n cells in total, n_parts is rounded up to a power of two.
+hash_part_table_t *hash_part_create(size_t n, size_t n_parts);
+
+// Partitions grow by themselves, see hash_create_resizable.
+hash_part_table_t *hash_part_create_resizable(size_t n, size_t n_parts, hash_fold_t fold, size_t link_offset);
+
+void hash_part_free(hash_part_table_t *table);
+
+void hash_part_s_lock(hash_part_t *part);
+
+void hash_part_x_lock(hash_part_t *part);
+
+void hash_part_unlock(hash_part_t *part);
+
+// Counters of partition i, or summed over all partitions if i is n_parts.
+void hash_part_get_stat(hash_part_table_t *table, size_t i, hash_part_stat_t *stat);
+
+static inline hash_part_t *hash_part_get(hash_part_table_t *table, size_t fold) {
+  uint64_t h = (uint64_t)fold * 0x9E3779B97F4A7C15ULL;
+  return table->parts + ((h >> 32) & (table->n_parts - 1));
+}
+
+#define HASH_PART_INSERT(TYPE, NAME, TABLE, FOLD, DATA)        \
+  do {                                                         \
+    size_t fold4444 = (FOLD);                                  \
+    hash_part_t *part4444 = hash_part_get(TABLE, fold4444);    \
+                                                               \
+    hash_part_x_lock(part4444);                                \
+    HASH_INSERT(TYPE, NAME, part4444->table, fold4444, DATA);  \
+    hash_part_unlock(part4444);                                \
+  } while (0)
+
+#define HASH_PART_DELETE(TYPE, NAME, TABLE, FOLD, DATA)        \
+  do {                                                         \
+    size_t fold4444 = (FOLD);                                  \
+    hash_part_t *part4444 = hash_part_get(TABLE, fold4444);    \
+                                                               \
+    hash_part_x_lock(part4444);                                \
+    HASH_DELETE(TYPE, NAME, part4444->table, fold4444, DATA);  \
+    hash_part_unlock(part4444);                                \
+  } while (0)
+
+/* TEST runs under the partition's shared lock, the node found is returned
+after the lock is released, the caller must keep it alive. */
+#define HASH_PART_SEARCH(NAME, TABLE, FOLD, TYPE, DATA, ASSERTION, TEST)          \
+  do {                                                                            \
+    size_t fold4444 = (FOLD);                                                     \
+    hash_part_t *part4444 = hash_part_get(TABLE, fold4444);                       \
+                                                                                  \
+    hash_part_s_lock(part4444);                                                   \
+    HASH_SEARCH_LOW(NAME, part4444->table, fold4444, TYPE, DATA, ASSERTION, TEST); \
+    hash_part_unlock(part4444);                                                   \
+  } while (0)
+
+#endif
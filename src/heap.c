@@ -5,69 +5,351 @@
  */
 #include "heap.h"
 #include "calc.h"
+#include "mutex.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
 
-#define MEM_ALIGNMENT 8
-#define MEM_BLOCK_HEADER_SIZE calc_align(sizeof(mem_block_t), MEM_ALIGNMENT)
-#define MEM_SPACE_NEEDED(N) calc_align((N), MEM_ALIGNMENT)
 #define MEM_BLOCK_START_SIZE 64
-#define MEM_BLOCK_STANDARD_SIZE 8000
+#define MEM_HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+#define MEM_HUGE_BLOCK_MAX_SIZE (64UL * 1024 * 1024)
+#define MEM_HEAP_INFO_SIZE MEM_SPACE_NEEDED(sizeof(mem_heap_info_t))
+
+// Process-wide counters, updated with relaxed atomics.
+static size_t mem_heap_n_heaps = 0;
+static size_t mem_heap_total_size = 0;
+
+static mutex_t mem_registry_mutex;
+static LIST(mem_heap_info_t) mem_registry;
+static pthread_once_t mem_registry_once = PTHREAD_ONCE_INIT;
+static bool mem_registry_enabled = false;
+
+/* Free standard-size blocks are kept in a process-wide cache so that heaps
+which are created and freed at a high rate do not go through malloc/free for
+every block. The cache is split into shards, each thread sticks to one shard. */
+#define MEM_CACHE_N_SHARDS 16
+#define MEM_CACHE_DEFAULT_MAX 1024
+
+// Requests at least this big are rounded up to a standard block on a cache miss.
+#define MEM_CACHE_MIN_SIZE (MEM_BLOCK_STANDARD_SIZE / 4)
+
+typedef struct mem_cache_shard_t mem_cache_shard_t;
+struct mem_cache_shard_t {
+  mutex_t mutex;
+  LIST(mem_block_t) blocks;
+  size_t hits;
+  size_t misses;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+static mem_cache_shard_t mem_cache_shards[MEM_CACHE_N_SHARDS];
+static size_t mem_cache_shard_max = MEM_CACHE_DEFAULT_MAX / MEM_CACHE_N_SHARDS;
+static pthread_once_t mem_cache_once = PTHREAD_ONCE_INIT;
+static size_t mem_cache_next_shard = 0;
+static __thread mem_cache_shard_t *mem_cache_shard = NULL;
+
+static void mem_cache_init(void) {
+  size_t i;
+
+  for (i = 0; i < MEM_CACHE_N_SHARDS; i++) {
+    mutex_init(&mem_cache_shards[i].mutex);
+    LIST_INIT(mem_cache_shards[i].blocks);
+    mem_cache_shards[i].hits = 0;
+    mem_cache_shards[i].misses = 0;
+  }
+}
+
+static mem_cache_shard_t *mem_cache_get_shard(void) {
+  size_t i;
+
+  if (mem_cache_shard == NULL) {
+    pthread_once(&mem_cache_once, mem_cache_init);
+    i = __atomic_fetch_add(&mem_cache_next_shard, 1, __ATOMIC_RELAXED);
+    mem_cache_shard = &mem_cache_shards[i % MEM_CACHE_N_SHARDS];
+  }
+
+  return mem_cache_shard;
+}
 
-static mem_block_t *mem_heap_create_block(mem_heap_t *heap, size_t n) {
+static mem_block_t *mem_cache_get_block(size_t len) {
+  mem_cache_shard_t *shard;
   mem_block_t *block;
+
+  assert(len <= MEM_BLOCK_STANDARD_SIZE);
+
+  shard = mem_cache_get_shard();
+
+  mutex_lock(&shard->mutex);
+
+  block = LIST_GET_FIRST(shard->blocks);
+  if (block != NULL) {
+    LIST_REMOVE(list, shard->blocks, block);
+    shard->hits++;
+  } else {
+    shard->misses++;
+  }
+
+  mutex_unlock(&shard->mutex);
+
+  return block;
+}
+
+static bool mem_cache_put_block(mem_block_t *block) {
+  mem_cache_shard_t *shard;
+  bool cached = false;
+
+  assert(block->len == MEM_BLOCK_STANDARD_SIZE);
+
+  shard = mem_cache_get_shard();
+
+  mutex_lock(&shard->mutex);
+
+  if (LIST_GET_LEN(shard->blocks) < mem_cache_shard_max) {
+    LIST_ADD_FIRST(list, shard->blocks, block);
+    cached = true;
+  }
+
+  mutex_unlock(&shard->mutex);
+
+  return cached;
+}
+
+static size_t mem_cache_shrink_shard(mem_cache_shard_t *shard, size_t max) {
+  mem_block_t *block;
+  size_t n_freed = 0;
+
+  mutex_lock(&shard->mutex);
+
+  while (LIST_GET_LEN(shard->blocks) > max) {
+    block = LIST_GET_LAST(shard->blocks);
+    LIST_REMOVE(list, shard->blocks, block);
+    free(block);
+    n_freed++;
+  }
+
+  mutex_unlock(&shard->mutex);
+
+  return n_freed;
+}
+
+void mem_heap_cache_set_max(size_t n_blocks) {
+  size_t i;
+  size_t max;
+
+  pthread_once(&mem_cache_once, mem_cache_init);
+
+  max = (n_blocks + MEM_CACHE_N_SHARDS - 1) / MEM_CACHE_N_SHARDS;
+  __atomic_store_n(&mem_cache_shard_max, max, __ATOMIC_RELAXED);
+
+  for (i = 0; i < MEM_CACHE_N_SHARDS; i++) {
+    mem_cache_shrink_shard(&mem_cache_shards[i], max);
+  }
+}
+
+void mem_heap_cache_get_stat(mem_heap_cache_stat_t *stat) {
+  mem_cache_shard_t *shard;
+  size_t i;
+
+  assert(stat);
+
+  pthread_once(&mem_cache_once, mem_cache_init);
+
+  stat->hits = 0;
+  stat->misses = 0;
+  stat->n_cached = 0;
+  stat->max_cached = mem_cache_shard_max * MEM_CACHE_N_SHARDS;
+
+  for (i = 0; i < MEM_CACHE_N_SHARDS; i++) {
+    shard = &mem_cache_shards[i];
+
+    mutex_lock(&shard->mutex);
+    stat->hits += shard->hits;
+    stat->misses += shard->misses;
+    stat->n_cached += LIST_GET_LEN(shard->blocks);
+    mutex_unlock(&shard->mutex);
+  }
+}
+
+size_t mem_heap_cache_trim(void) {
+  size_t i;
+  size_t n_freed = 0;
+
+  pthread_once(&mem_cache_once, mem_cache_init);
+
+  for (i = 0; i < MEM_CACHE_N_SHARDS; i++) {
+    n_freed += mem_cache_shrink_shard(&mem_cache_shards[i], 0);
+  }
+
+  return n_freed;
+}
+
+static void mem_registry_init(void) {
+  mutex_init(&mem_registry_mutex);
+  LIST_INIT(mem_registry);
+}
+
+void mem_heap_registry_enable(bool enable) {
+  pthread_once(&mem_registry_once, mem_registry_init);
+  __atomic_store_n(&mem_registry_enabled, enable, __ATOMIC_RELAXED);
+}
+
+static void mem_registry_add(mem_heap_info_t *info) {
+  pthread_once(&mem_registry_once, mem_registry_init);
+
+  mutex_lock(&mem_registry_mutex);
+  LIST_ADD_LAST(list, mem_registry, info);
+  info->registered = true;
+  mutex_unlock(&mem_registry_mutex);
+}
+
+static void mem_registry_remove(mem_heap_info_t *info) {
+  mutex_lock(&mem_registry_mutex);
+  LIST_REMOVE(list, mem_registry, info);
+  info->registered = false;
+  mutex_unlock(&mem_registry_mutex);
+}
+
+/* Maps len bytes at a MEM_HUGE_PAGE_SIZE boundary so that the kernel can back
+the region with transparent huge pages. If it refuses, the region simply stays
+on normal pages. */
+static mem_block_t *mem_block_alloc_huge(size_t len) {
+  byte *ptr;
+  byte *start;
+  size_t head;
+  size_t tail;
+
+  assert(len % MEM_HUGE_PAGE_SIZE == 0);
+
+  ptr = mmap(NULL, len + MEM_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  assert(ptr != MAP_FAILED);
+
+  start = (byte *)calc_align((uintptr_t)ptr, MEM_HUGE_PAGE_SIZE);
+  head = start - ptr;
+  tail = MEM_HUGE_PAGE_SIZE - head;
+
+  if (head > 0) {
+    munmap(ptr, head);
+  }
+  if (tail > 0) {
+    munmap(start + len, tail);
+  }
+
+#ifdef MADV_HUGEPAGE
+  madvise(start, len, MADV_HUGEPAGE);
+#endif
+
+  return (mem_block_t *)start;
+}
+
+static mem_block_t *mem_heap_create_block(mem_heap_t *heap, size_t n, size_t type) {
+  mem_block_t *block = NULL;
   size_t len;
 
   len = MEM_BLOCK_HEADER_SIZE + MEM_SPACE_NEEDED(n);
 
-  block = malloc(len);
-  assert(block);
+  if (type == MEM_HEAP_HUGE) {
+    len = calc_align(len, MEM_HUGE_PAGE_SIZE);
+    block = mem_block_alloc_huge(len);
+  } else if (len <= MEM_BLOCK_STANDARD_SIZE) {
+    block = mem_cache_get_block(len);
+
+    if (block == NULL && len >= MEM_CACHE_MIN_SIZE) {
+      len = MEM_BLOCK_STANDARD_SIZE;
+    }
+  }
+
+  if (type == MEM_HEAP_HUGE) {
+    assert(block);
+  } else if (block != NULL) {
+    len = MEM_BLOCK_STANDARD_SIZE;
+  } else {
+    block = malloc(len);
+    assert(block);
+  }
 
   block->len = len;
+  block->type = type;
   block->free = MEM_BLOCK_HEADER_SIZE;
   block->start = MEM_BLOCK_HEADER_SIZE;
+  block->info = NULL;
 
   if (heap == NULL) {
     block->total_size = len;
   } else {
-    heap->total_size += len;
+    // the registry reads these from other threads
+    __atomic_store_n(&heap->total_size, heap->total_size + len, __ATOMIC_RELAXED);
+    __atomic_store_n(&heap->info->peak_size, max(heap->info->peak_size, heap->total_size), __ATOMIC_RELAXED);
   }
 
+  __atomic_fetch_add(&mem_heap_total_size, len, __ATOMIC_RELAXED);
+
   assert(MEM_BLOCK_HEADER_SIZE < len);
 
   return block;
 }
 
-mem_heap_t *mem_heap_create(size_t n) {
+mem_heap_t *mem_heap_create_func(size_t n, size_t type, const char *name) {
   mem_block_t *block;
+  mem_heap_info_t *info;
+
+  assert(type == MEM_HEAP_DYNAMIC || type == MEM_HEAP_HUGE);
 
   if (!n) {
     n = MEM_BLOCK_START_SIZE;
   }
 
-  block = mem_heap_create_block(NULL, n);
+  block = mem_heap_create_block(NULL, n + MEM_HEAP_INFO_SIZE, type);
   assert(block);
 
+  info = (mem_heap_info_t *)((byte *)block + block->start);
+  memset(info, 0x0, sizeof(*info));
+  info->name = name;
+  info->heap = block;
+  info->peak_size = block->total_size;
+
+  block->info = info;
+  block->start += MEM_HEAP_INFO_SIZE;
+  block->free = block->start;
+
   LIST_INIT(block->base);
 
   LIST_ADD_FIRST(list, block->base, block);
 
+  __atomic_fetch_add(&mem_heap_n_heaps, 1, __ATOMIC_RELAXED);
+
+  if (__atomic_load_n(&mem_registry_enabled, __ATOMIC_RELAXED)) {
+    mem_registry_add(info);
+  }
+
   return block;
 }
 
 static void mem_heap_block_free(mem_heap_t *heap, mem_block_t *block) {
-  LIST_REMOVE(list, block->base, block);
+  LIST_REMOVE(list, heap->base, block);
 
   assert(heap->total_size >= block->len);
-  heap->total_size -= block->len;
+  __atomic_store_n(&heap->total_size, heap->total_size - block->len, __ATOMIC_RELAXED);
+
+  __atomic_fetch_sub(&mem_heap_total_size, block->len, __ATOMIC_RELAXED);
 
-  free(block);
+  if (block->type == MEM_HEAP_HUGE) {
+    munmap(block, block->len);
+  } else if (block->len != MEM_BLOCK_STANDARD_SIZE || !mem_cache_put_block(block)) {
+    free(block);
+  }
 }
 
 void mem_heap_free(mem_heap_t *heap) {
   mem_block_t *block;
   mem_block_t *prev_block;
 
+  if (heap->info->registered) {
+    mem_registry_remove(heap->info);
+  }
+
+  __atomic_fetch_sub(&mem_heap_n_heaps, 1, __ATOMIC_RELAXED);
+
   block = LIST_GET_LAST(heap->base);
   while (block != NULL) {
     prev_block = LIST_GET_PREV(list, block);
@@ -87,15 +369,24 @@ static mem_block_t *mem_heap_add_block(mem_heap_t *heap, size_t n) {
 
   new_size = 2 * block->len;
 
-  if (new_size > MEM_BLOCK_STANDARD_SIZE) {
-    new_size = MEM_BLOCK_STANDARD_SIZE;
+  if (heap->type == MEM_HEAP_HUGE) {
+    /* Huge blocks keep doubling up to a much larger cap, so that a big heap
+    is made of a few large regions instead of a long chain of blocks. */
+    if (new_size > MEM_HUGE_BLOCK_MAX_SIZE) {
+      new_size = MEM_HUGE_BLOCK_MAX_SIZE;
+    }
+    new_size -= MEM_BLOCK_HEADER_SIZE;
+  } else if (new_size > MEM_BLOCK_STANDARD_SIZE - MEM_BLOCK_HEADER_SIZE) {
+    /* Cap the whole block, header included, at the standard size so that
+    full-grown blocks can be recycled through the block cache. */
+    new_size = MEM_BLOCK_STANDARD_SIZE - MEM_BLOCK_HEADER_SIZE;
   }
 
   if (new_size < n) {
     new_size = n;
   }
 
-  new_block = mem_heap_create_block(heap, new_size);
+  new_block = mem_heap_create_block(heap, new_size, heap->type);
   assert(new_block);
 
   LIST_INSERT_AFTER(list, heap->base, block, new_block);
@@ -103,20 +394,23 @@ static mem_block_t *mem_heap_add_block(mem_heap_t *heap, size_t n) {
   return new_block;
 }
 
-void *mem_heap_alloc(mem_heap_t *heap, size_t n) {
+void *mem_heap_alloc_low(mem_heap_t *heap, size_t n, size_t align) {
   mem_block_t *block;
-  void *buf;
+  byte *buf;
+  size_t free;
 
-  block = LIST_GET_LAST(heap->base);
+  /* Block data starts at a MEM_ALIGNMENT boundary, leave room for padding
+  up to the requested alignment. */
+  block = mem_heap_add_block(heap, MEM_SPACE_NEEDED(n) + align - MEM_ALIGNMENT);
+  assert(block);
 
-  if (block->len < block->free + MEM_SPACE_NEEDED(n)) {
-    block = mem_heap_add_block(heap, n);
-    assert(block);
-  }
+  buf = (byte *)calc_align((uintptr_t)block + block->free, align);
+  free = buf - (byte *)block + MEM_SPACE_NEEDED(n);
+  assert(free <= block->len);
 
-  buf = (byte *)block + block->free;
+  mem_heap_info_add(heap, n, free - block->free);
 
-  block->free += MEM_SPACE_NEEDED(n);
+  block->free = free;
 
   return buf;
 }
@@ -161,7 +455,18 @@ void mem_heap_free_heap_top(mem_heap_t *heap, byte *old_top) {
 }
 
 void mem_heap_empty(mem_heap_t *heap) {
+  size_t keep;
+
   mem_heap_free_heap_top(heap, (byte *)heap + heap->start);
+
+  /* The mapping of a huge heap is kept, but the pages past the first huge
+  page are handed back to the kernel until they are written again. */
+  if (heap->type == MEM_HEAP_HUGE) {
+    keep = calc_align(heap->start, MEM_HUGE_PAGE_SIZE);
+    if (keep < heap->len) {
+      madvise((byte *)heap + keep, heap->len - keep, MADV_DONTNEED);
+    }
+  }
 }
 
 void *mem_heap_get_top(mem_heap_t *heap, size_t n) {
@@ -190,4 +495,232 @@ void mem_heap_free_top(mem_heap_t *heap, size_t n) {
 
 size_t mem_heap_get_size(mem_heap_t *heap) {
   return heap->total_size;
-}
\ No newline at end of file
+}
+
+void mem_heap_get_stat(mem_heap_t *heap, mem_heap_stat_t *stat) {
+  mem_block_t *block;
+  mem_heap_info_t *info;
+
+  assert(heap);
+  assert(stat);
+
+  info = heap->info;
+
+  stat->name = info->name;
+  stat->n_blocks = LIST_GET_LEN(heap->base);
+  stat->total_size = heap->total_size;
+  stat->peak_size = info->peak_size;
+  stat->used = 0;
+  stat->tail_waste = 0;
+  stat->n_allocs = info->n_allocs;
+  stat->requested = info->requested;
+  stat->round_waste = info->reserved - info->requested;
+  memcpy(stat->hist, info->hist, sizeof(stat->hist));
+
+  LIST_FOREACH(list, block, heap->base) {
+    stat->used += block->free - block->start;
+
+    if (block != LIST_GET_LAST(heap->base)) {
+      stat->tail_waste += block->len - block->free;
+    }
+  }
+}
+
+static void mem_heap_print_hist(const size_t *hist, FILE *file) {
+  size_t i;
+  size_t n;
+
+  fprintf(file, "  sizes:");
+  for (i = 0; i < MEM_HEAP_HIST_SIZE; i++) {
+    n = __atomic_load_n(&hist[i], __ATOMIC_RELAXED);
+    if (n != 0) {
+      fprintf(file, " %zu+:%zu", (size_t)1 << i, n);
+    }
+  }
+  fprintf(file, "\n");
+}
+
+void mem_heap_print_stat(mem_heap_t *heap, FILE *file) {
+  mem_heap_stat_t stat;
+
+  assert(file);
+
+  mem_heap_get_stat(heap, &stat);
+
+  fprintf(file,
+          "heap %p %s: blocks %zu, size %zu, peak %zu, used %zu, "
+          "allocs %zu, requested %zu, rounding waste %zu, tail waste %zu\n",
+          (void *)heap, stat.name ? stat.name : "(unnamed)", stat.n_blocks,
+          stat.total_size, stat.peak_size, stat.used, stat.n_allocs,
+          stat.requested, stat.round_waste, stat.tail_waste);
+
+  mem_heap_print_hist(stat.hist, file);
+}
+
+size_t mem_heap_get_n_heaps(void) {
+  return __atomic_load_n(&mem_heap_n_heaps, __ATOMIC_RELAXED);
+}
+
+size_t mem_heap_get_total_size(void) {
+  return __atomic_load_n(&mem_heap_total_size, __ATOMIC_RELAXED);
+}
+
+/* Heaps are owned by other threads, which may free or relink their blocks
+at any time, so only the counters the owners store atomically are printed
+and no block list is walked. The registry mutex keeps the heaps, and the
+info in their first block, from being freed meanwhile. */
+void mem_heap_registry_print(FILE *file) {
+  mem_heap_info_t *info;
+
+  assert(file);
+
+  pthread_once(&mem_registry_once, mem_registry_init);
+
+  mutex_lock(&mem_registry_mutex);
+
+  fprintf(file, "heaps: %zu live, %zu bytes, %zu registered\n",
+          mem_heap_get_n_heaps(), mem_heap_get_total_size(),
+          LIST_GET_LEN(mem_registry));
+
+  LIST_FOREACH(list, info, mem_registry) {
+    fprintf(file, "heap %p %s: size %zu, peak %zu, allocs %zu, requested %zu\n", (void *)info->heap,
+            info->name ? info->name : "(unnamed)", __atomic_load_n(&info->heap->total_size, __ATOMIC_RELAXED),
+            __atomic_load_n(&info->peak_size, __ATOMIC_RELAXED), __atomic_load_n(&info->n_allocs, __ATOMIC_RELAXED),
+            __atomic_load_n(&info->requested, __ATOMIC_RELAXED));
+    mem_heap_print_hist(info->hist, file);
+  }
+
+  mutex_unlock(&mem_registry_mutex);
+}
+
+void *mem_heap_realloc_top(mem_heap_t *heap, void *buf, size_t old_n, size_t new_n) {
+  mem_block_t *block;
+  void *new_buf;
+  size_t free;
+
+  assert(buf || !old_n);
+
+  block = LIST_GET_LAST(heap->base);
+
+  if (buf != NULL && (byte *)buf + MEM_SPACE_NEEDED(old_n) == (byte *)block + block->free) {
+    free = (byte *)buf - (byte *)block + MEM_SPACE_NEEDED(new_n);
+
+    if (free <= block->len) {
+#ifdef MEM_HEAP_STATS
+      if (new_n > old_n) {
+        __atomic_store_n(&heap->info->requested, heap->info->requested + new_n - old_n, __ATOMIC_RELAXED);
+        __atomic_store_n(&heap->info->reserved, heap->info->reserved + free - block->free, __ATOMIC_RELAXED);
+      }
+#endif
+
+      block->free = free;
+
+      return buf;
+    }
+  }
+
+  new_buf = mem_heap_alloc(heap, new_n);
+
+  if (old_n > 0) {
+    memcpy(new_buf, buf, min(old_n, new_n));
+  }
+
+  return new_buf;
+}
+
+char *mem_heap_strdup(mem_heap_t *heap, const char *str) {
+  return mem_heap_strdupl(heap, str, strlen(str));
+}
+
+char *mem_heap_strdupl(mem_heap_t *heap, const char *str, size_t len) {
+  char *s;
+
+  s = mem_heap_alloc(heap, len + 1);
+  memcpy(s, str, len);
+  s[len] = '\0';
+
+  return s;
+}
+
+char *mem_heap_printf(mem_heap_t *heap, const char *format, ...) {
+  mem_str_t str;
+  va_list args;
+
+  mem_str_init(&str, heap);
+
+  va_start(args, format);
+  mem_str_vprintf(&str, format, args);
+  va_end(args);
+
+  return mem_str_finish(&str);
+}
+
+#define MEM_STR_START_SIZE 64
+
+void mem_str_init(mem_str_t *str, mem_heap_t *heap) {
+  assert(str);
+  assert(heap);
+
+  str->heap = heap;
+  str->size = MEM_STR_START_SIZE;
+  str->data = mem_heap_alloc(heap, str->size);
+  str->len = 0;
+  str->data[0] = '\0';
+}
+
+// Makes room for n more characters and the terminating NUL.
+static void mem_str_reserve(mem_str_t *str, size_t n) {
+  size_t size;
+
+  if (str->len + n < str->size) {
+    return;
+  }
+
+  size = max(2 * str->size, str->len + n + 1);
+
+  str->data = mem_heap_realloc_top(str->heap, str->data, str->size, size);
+  str->size = size;
+}
+
+void mem_str_append(mem_str_t *str, const char *data, size_t len) {
+  mem_str_reserve(str, len);
+
+  memcpy(str->data + str->len, data, len);
+  str->len += len;
+  str->data[str->len] = '\0';
+}
+
+void mem_str_vprintf(mem_str_t *str, const char *format, va_list args) {
+  va_list args2;
+  int len;
+
+  va_copy(args2, args);
+  len = vsnprintf(str->data + str->len, str->size - str->len, format, args2);
+  va_end(args2);
+
+  assert(len >= 0);
+
+  if ((size_t)len >= str->size - str->len) {
+    mem_str_reserve(str, len);
+
+    len = vsnprintf(str->data + str->len, str->size - str->len, format, args);
+    assert(len >= 0 && (size_t)len < str->size - str->len);
+  }
+
+  str->len += len;
+}
+
+void mem_str_printf(mem_str_t *str, const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  mem_str_vprintf(str, format, args);
+  va_end(args);
+}
+
+char *mem_str_finish(mem_str_t *str) {
+  str->data = mem_heap_realloc_top(str->heap, str->data, str->size, str->len + 1);
+  str->size = str->len + 1;
+
+  return str->data;
+}
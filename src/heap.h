@@ -7,24 +7,154 @@
 #define HEAP_H
 #include "byte.h"
 #include "lst.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Blocks are allocated with malloc and recycled through the block cache.
+#define MEM_HEAP_DYNAMIC 0
+// Blocks are 2 MiB aligned mmap regions backed by huge pages when available.
+#define MEM_HEAP_HUGE 1
+
+// Default alignment of heap allocations.
+#define MEM_ALIGNMENT 8
+#define MEM_SPACE_NEEDED(N) MEM_ALIGN((N), MEM_ALIGNMENT)
+
+/* Local copies of calc.h helpers for the inline fast path, so that including
+heap.h does not define min and max everywhere. */
+#define MEM_ALIGN(N, M) (((N) + ((M) - 1)) & ~((M) - 1))
+#define MEM_MIN(A, B) ((A) < (B) ? (A) : (B))
+
+// Allocation sizes are counted in buckets of [2^i, 2^(i+1)), the last one is open.
+#define MEM_HEAP_HIST_SIZE 16
+
+#define MEM_HEAP_STR(X) MEM_HEAP_STR_LOW(X)
+#define MEM_HEAP_STR_LOW(X) #X
+#define MEM_HEAP_SITE __FILE__ ":" MEM_HEAP_STR(__LINE__)
 
 typedef struct mem_block_t mem_block_t;
+typedef struct mem_heap_info_t mem_heap_info_t;
+
 struct mem_block_t {
     LIST(mem_block_t) base;
     LIST_NODE(mem_block_t) list;
     size_t len;
     size_t total_size;
+    size_t type;
     size_t free;
     size_t start;
+    mem_heap_info_t *info;
 };
 
 typedef mem_block_t mem_heap_t;
 
-mem_heap_t *mem_heap_create(size_t n);
+#define MEM_BLOCK_HEADER_SIZE MEM_SPACE_NEEDED(sizeof(mem_block_t))
+// Blocks of a dynamic heap stop doubling at this size, header included.
+#define MEM_BLOCK_STANDARD_SIZE 8000
+
+// Allocation counters of a heap, kept right after the header of its first block.
+struct mem_heap_info_t {
+    const char *name;
+    mem_heap_t *heap;
+    LIST_NODE(mem_heap_info_t) list;
+    bool registered;
+    size_t n_allocs;
+    size_t requested;
+    size_t reserved;
+    size_t peak_size;
+    size_t hist[MEM_HEAP_HIST_SIZE];
+};
+
+typedef struct mem_heap_stat_t mem_heap_stat_t;
+struct mem_heap_stat_t {
+    const char *name;
+    size_t n_blocks;
+    size_t total_size;
+    size_t peak_size;
+    size_t used;
+    size_t tail_waste;
+    size_t n_allocs;
+    size_t requested;
+    size_t round_waste;
+    size_t hist[MEM_HEAP_HIST_SIZE];
+};
+
+#define mem_heap_create(N) mem_heap_create_func((N), MEM_HEAP_DYNAMIC, MEM_HEAP_SITE)
+
+#define mem_heap_create_typed(N, TYPE) mem_heap_create_func((N), (TYPE), MEM_HEAP_SITE)
+
+// The name tags the heap in statistics and in the heap registry, it is not copied.
+mem_heap_t *mem_heap_create_func(size_t n, size_t type, const char *name);
 
 void mem_heap_free(mem_heap_t *heap);
 
-void *mem_heap_alloc(mem_heap_t *heap, size_t n);
+// Out-of-line part of mem_heap_alloc_aligned, adds a block that fits the request.
+void *mem_heap_alloc_low(mem_heap_t *heap, size_t n, size_t align);
+
+/* Counting allocations costs a few stores on the inline path, so it is only
+compiled in with MEM_HEAP_STATS, which the library and its users must agree
+on. Without it n_allocs, requested, the rounding waste and the histogram stay
+zero, the block-level numbers are always there. */
+#ifdef MEM_HEAP_STATS
+static inline size_t mem_heap_hist_slot(size_t n) {
+  size_t slot;
+
+  if (n == 0) {
+    return 0;
+  }
+
+  slot = sizeof(unsigned long) * CHAR_BIT - 1 - __builtin_clzl(n);
+
+  return MEM_MIN(slot, MEM_HEAP_HIST_SIZE - 1);
+}
+
+static inline void mem_heap_info_add(mem_heap_t *heap, size_t n, size_t reserved) {
+  mem_heap_info_t *info = heap->info;
+
+  // plain loads and relaxed stores, only the registry reads them concurrently
+  __atomic_store_n(&info->n_allocs, info->n_allocs + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&info->requested, info->requested + n, __ATOMIC_RELAXED);
+  __atomic_store_n(&info->reserved, info->reserved + reserved, __ATOMIC_RELAXED);
+  __atomic_store_n(&info->hist[mem_heap_hist_slot(n)], info->hist[mem_heap_hist_slot(n)] + 1, __ATOMIC_RELAXED);
+}
+#else
+#define mem_heap_info_add(HEAP, N, RESERVED) ((void)0)
+#endif
+
+/* Allocates n bytes aligned to align, a power of two not smaller than
+MEM_ALIGNMENT. Only a request that does not fit in the last block leaves the
+inline path. Padding inserted for alignment is counted as rounding waste, and
+the result must not be released with mem_heap_free_top. */
+static inline void *mem_heap_alloc_aligned(mem_heap_t *heap, size_t n, size_t align) {
+  mem_block_t *block;
+  byte *buf;
+  size_t free;
+
+  assert((align & (align - 1)) == 0 && align >= MEM_ALIGNMENT);
+
+  block = LIST_GET_LAST(heap->base);
+
+  buf = (byte *)MEM_ALIGN((uintptr_t)block + block->free, align);
+  free = buf - (byte *)block + MEM_SPACE_NEEDED(n);
+
+  if (free > block->len) {
+    return mem_heap_alloc_low(heap, n, align);
+  }
+
+  mem_heap_info_add(heap, n, free - block->free);
+
+  block->free = free;
+
+  return buf;
+}
+
+static inline void *mem_heap_alloc(mem_heap_t *heap, size_t n) {
+  return mem_heap_alloc_aligned(heap, n, MEM_ALIGNMENT);
+}
 
 byte *mem_heap_get_heap_top(mem_heap_t *heap);
 
@@ -38,4 +168,73 @@ void mem_heap_free_top(mem_heap_t *heap, size_t n);
 
 size_t mem_heap_get_size(mem_heap_t *heap);
 
+/* Resizes buf, an allocation of old_n bytes, to new_n bytes. If buf is the top
+of the last block and the block has room, it is resized in place, otherwise
+the contents are moved to a new allocation. buf may be NULL when old_n is 0. */
+void *mem_heap_realloc_top(mem_heap_t *heap, void *buf, size_t old_n, size_t new_n);
+
+char *mem_heap_strdup(mem_heap_t *heap, const char *str);
+
+char *mem_heap_strdupl(mem_heap_t *heap, const char *str, size_t len);
+
+char *mem_heap_printf(mem_heap_t *heap, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/* A string built at the top of a heap. As long as nothing else is allocated
+from the heap meanwhile, appending grows the buffer in place. */
+typedef struct mem_str_t mem_str_t;
+struct mem_str_t {
+    mem_heap_t *heap;
+    char *data;
+    size_t len;
+    size_t size;
+};
+
+void mem_str_init(mem_str_t *str, mem_heap_t *heap);
+
+void mem_str_append(mem_str_t *str, const char *data, size_t len);
+
+void mem_str_printf(mem_str_t *str, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+void mem_str_vprintf(mem_str_t *str, const char *format, va_list args);
+
+// Trims the buffer to the string and returns it, NUL-terminated.
+char *mem_str_finish(mem_str_t *str);
+
+typedef struct mem_heap_cache_stat_t mem_heap_cache_stat_t;
+struct mem_heap_cache_stat_t {
+    size_t hits;
+    size_t misses;
+    size_t n_cached;
+    size_t max_cached;
+};
+
+// Sets how many free standard-size blocks the process-wide block cache may retain.
+void mem_heap_cache_set_max(size_t n_blocks);
+
+void mem_heap_cache_get_stat(mem_heap_cache_stat_t *stat);
+
+// Releases every cached block back to the system, returns the number released.
+size_t mem_heap_cache_trim(void);
+
+/* Fills in the counters of a heap. n_allocs, requested and the histogram count
+every mem_heap_alloc since the heap was created if MEM_HEAP_STATS is defined, the other fields describe the
+blocks the heap holds right now, so only the thread using the heap may call
+it. */
+void mem_heap_get_stat(mem_heap_t *heap, mem_heap_stat_t *stat);
+
+void mem_heap_print_stat(mem_heap_t *heap, FILE *file);
+
+// Number of live heaps and bytes held by their blocks, across the process.
+size_t mem_heap_get_n_heaps(void);
+
+size_t mem_heap_get_total_size(void);
+
+/* While enabled, newly created heaps are tracked in a registry until freed.
+The dump may run on any thread, it prints the size and allocation counters
+of each heap but not the block-level numbers of mem_heap_get_stat, which
+only the owning thread may compute. */
+void mem_heap_registry_enable(bool enable);
+
+void mem_heap_registry_print(FILE *file);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,322 @@
+/**
+ * @file hmap.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "hmap.h"
+#include "calc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HMAP_EMPTY 0x80
+#define HMAP_MIN_CAPACITY 32
+
+#define hmap_h1(HASH) ((HASH) >> 7)
+#define hmap_h2(HASH) ((byte)((HASH) & 0x7F))
+
+/* hmap_match returns a mask with one bit per control byte of the group that
+equals tag, hmap_match_empty one per empty slot. HMAP_MASK_STRIDE is the
+distance between the bits of two neighbouring slots. */
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define HMAP_GROUP_WIDTH 32
+  #define HMAP_MASK_STRIDE 1
+typedef uint32_t hmap_mask_t;
+
+static inline hmap_mask_t hmap_match(const byte *group, byte tag) {
+  __m256i ctrl = _mm256_loadu_si256((const __m256i *)group);
+  return (hmap_mask_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8((char)tag)));
+}
+
+static inline hmap_mask_t hmap_match_empty(const byte *group) {
+  return (hmap_mask_t)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)group));
+}
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+  #define HMAP_GROUP_WIDTH 16
+  #define HMAP_MASK_STRIDE 1
+typedef uint32_t hmap_mask_t;
+
+static inline hmap_mask_t hmap_match(const byte *group, byte tag) {
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (hmap_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+}
+
+static inline hmap_mask_t hmap_match_empty(const byte *group) {
+  return (hmap_mask_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+#else
+  #define HMAP_GROUP_WIDTH 8
+  #define HMAP_MASK_STRIDE 8
+  #define HMAP_LSB 0x0101010101010101ULL
+  #define HMAP_MSB 0x8080808080808080ULL
+typedef uint64_t hmap_mask_t;
+
+// May report a byte right after a real match, such candidates fail the key compare.
+static inline hmap_mask_t hmap_match(const byte *group, byte tag) {
+  uint64_t ctrl;
+  memcpy(&ctrl, group, sizeof(ctrl));
+  ctrl ^= HMAP_LSB * tag;
+  return (ctrl - HMAP_LSB) & ~ctrl & HMAP_MSB;
+}
+
+static inline hmap_mask_t hmap_match_empty(const byte *group) {
+  uint64_t ctrl;
+  memcpy(&ctrl, group, sizeof(ctrl));
+  return ctrl & HMAP_MSB;
+}
+#endif
+
+#define hmap_mask_first(MASK) ((size_t)__builtin_ctzll(MASK) / HMAP_MASK_STRIDE)
+
+#define hmap_slot(MAP, I) ((MAP)->slots + (I) * (MAP)->slot_size)
+#define hmap_slot_value(MAP, I) (hmap_slot(MAP, I) + (MAP)->value_offset)
+
+static inline size_t hmap_hash(const hmap_t *map, const void *key) {
+  if (map->hash != NULL) {
+    return map->hash(key);
+  }
+  return calc_fold_binary((const byte *)key, map->key_size);
+}
+
+static inline bool hmap_equal(const hmap_t *map, const void *key1, const void *key2) {
+  if (map->equal != NULL) {
+    return map->equal(key1, key2);
+  }
+  return memcmp(key1, key2, map->key_size) == 0;
+}
+
+/* The first HMAP_GROUP_WIDTH control bytes are mirrored after the end, so that
+a group can be loaded at any position without wrapping. */
+static inline void hmap_set_ctrl(hmap_t *map, size_t i, byte ctrl) {
+  map->ctrl[i] = ctrl;
+  if (i < HMAP_GROUP_WIDTH) {
+    map->ctrl[map->capacity + i] = ctrl;
+  }
+}
+
+static void hmap_alloc(hmap_t *map, size_t capacity) {
+  assert(calc_is_2pow(capacity) && capacity >= HMAP_GROUP_WIDTH);
+
+  map->capacity = capacity;
+  map->ctrl = malloc(capacity + HMAP_GROUP_WIDTH);
+  assert(map->ctrl);
+  map->slots = malloc(capacity * map->slot_size);
+  assert(map->slots);
+
+  memset(map->ctrl, HMAP_EMPTY, capacity + HMAP_GROUP_WIDTH);
+}
+
+static size_t hmap_find_empty(const hmap_t *map, size_t hash) {
+  size_t mask = map->capacity - 1;
+  size_t pos = hmap_h1(hash) & mask;
+  hmap_mask_t empty;
+
+  for (;;) {
+    empty = hmap_match_empty(map->ctrl + pos);
+    if (empty) {
+      return (pos + hmap_mask_first(empty)) & mask;
+    }
+    pos = (pos + HMAP_GROUP_WIDTH) & mask;
+  }
+}
+
+static size_t hmap_find_slot(const hmap_t *map, const void *key, size_t hash, bool *found) {
+  size_t mask = map->capacity - 1;
+  size_t pos = hmap_h1(hash) & mask;
+  size_t i;
+  hmap_mask_t match;
+  hmap_mask_t empty;
+
+  for (;;) {
+    match = hmap_match(map->ctrl + pos, hmap_h2(hash));
+
+    while (match) {
+      i = (pos + hmap_mask_first(match)) & mask;
+      if (hmap_equal(map, key, hmap_slot(map, i))) {
+        *found = true;
+        return i;
+      }
+      match &= match - 1;
+    }
+
+    /* Entries are never separated from their home slot by an empty slot, so
+    the key cannot be past the first empty slot of this group. */
+    empty = hmap_match_empty(map->ctrl + pos);
+    if (empty) {
+      *found = false;
+      return (pos + hmap_mask_first(empty)) & mask;
+    }
+
+    pos = (pos + HMAP_GROUP_WIDTH) & mask;
+  }
+}
+
+static void hmap_grow(hmap_t *map) {
+  byte *old_ctrl = map->ctrl;
+  byte *old_slots = map->slots;
+  size_t old_capacity = map->capacity;
+  size_t i;
+  size_t j;
+  size_t hash;
+
+  hmap_alloc(map, 2 * old_capacity);
+
+  for (i = 0; i < old_capacity; i++) {
+    if (old_ctrl[i] & HMAP_EMPTY) {
+      continue;
+    }
+
+    hash = hmap_hash(map, old_slots + i * map->slot_size);
+    j = hmap_find_empty(map, hash);
+    hmap_set_ctrl(map, j, hmap_h2(hash));
+    memcpy(hmap_slot(map, j), old_slots + i * map->slot_size, map->slot_size);
+  }
+
+  free(old_ctrl);
+  free(old_slots);
+}
+
+hmap_t *hmap_create(size_t key_size, size_t value_size, hmap_hash_t hash, BinaryPred equal, size_t n) {
+  hmap_t *map;
+  size_t capacity;
+
+  assert(key_size);
+
+  map = malloc(sizeof(hmap_t));
+  assert(map);
+
+  map->size = 0;
+  map->key_size = key_size;
+  map->value_size = value_size;
+  map->value_offset = calc_align(key_size, sizeof(void *));
+  map->slot_size = calc_align(map->value_offset + value_size, sizeof(void *));
+  map->hash = hash;
+  map->equal = equal;
+
+  capacity = calc_2_power_up(max(n + n / 7 + 1, HMAP_MIN_CAPACITY));
+  hmap_alloc(map, capacity);
+
+  return map;
+}
+
+void hmap_free(hmap_t *map) {
+  assert(map);
+  free(map->ctrl);
+  free(map->slots);
+  free(map);
+}
+
+void hmap_clear(hmap_t *map) {
+  assert(map);
+  memset(map->ctrl, HMAP_EMPTY, map->capacity + HMAP_GROUP_WIDTH);
+  map->size = 0;
+}
+
+size_t hmap_size(const hmap_t *map) {
+  assert(map);
+  return map->size;
+}
+
+void *hmap_find(const hmap_t *map, const void *key) {
+  size_t i;
+  bool found;
+
+  assert(map);
+
+  i = hmap_find_slot(map, key, hmap_hash(map, key), &found);
+
+  return found ? hmap_slot_value(map, i) : NULL;
+}
+
+void *hmap_insert(hmap_t *map, const void *key, const void *value, bool *inserted) {
+  size_t hash;
+  size_t i;
+  bool found;
+
+  assert(map);
+
+  hash = hmap_hash(map, key);
+  i = hmap_find_slot(map, key, hash, &found);
+
+  if (inserted != NULL) {
+    *inserted = !found;
+  }
+
+  if (found) {
+    return hmap_slot_value(map, i);
+  }
+
+  if (map->size + 1 > map->capacity - map->capacity / 8) {
+    hmap_grow(map);
+    i = hmap_find_empty(map, hash);
+  }
+
+  hmap_set_ctrl(map, i, hmap_h2(hash));
+  memcpy(hmap_slot(map, i), key, map->key_size);
+  if (value != NULL) {
+    memcpy(hmap_slot_value(map, i), value, map->value_size);
+  }
+
+  map->size++;
+
+  return hmap_slot_value(map, i);
+}
+
+bool hmap_erase(hmap_t *map, const void *key) {
+  size_t mask;
+  size_t hole;
+  size_t i;
+  size_t home;
+  bool found;
+
+  assert(map);
+
+  hole = hmap_find_slot(map, key, hmap_hash(map, key), &found);
+  if (!found) {
+    return false;
+  }
+
+  mask = map->capacity - 1;
+
+  /* Shift back every following entry of the run whose home slot is not
+  between the hole and its current slot, then the last hole becomes empty. */
+  for (i = (hole + 1) & mask; !(map->ctrl[i] & HMAP_EMPTY); i = (i + 1) & mask) {
+    home = hmap_h1(hmap_hash(map, hmap_slot(map, i))) & mask;
+
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      hmap_set_ctrl(map, hole, map->ctrl[i]);
+      memcpy(hmap_slot(map, hole), hmap_slot(map, i), map->slot_size);
+      hole = i;
+    }
+  }
+
+  hmap_set_ctrl(map, hole, HMAP_EMPTY);
+  map->size--;
+
+  return true;
+}
+
+bool hmap_next(const hmap_t *map, size_t *pos, void **key, void **value) {
+  size_t i;
+
+  assert(map);
+  assert(pos);
+
+  for (i = *pos; i < map->capacity; i++) {
+    if (!(map->ctrl[i] & HMAP_EMPTY)) {
+      if (key != NULL) {
+        *key = hmap_slot(map, i);
+      }
+      if (value != NULL) {
+        *value = hmap_slot_value(map, i);
+      }
+      *pos = i + 1;
+      return true;
+    }
+  }
+
+  *pos = map->capacity;
+  return false;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file hmap.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef HMAP_H
+#define HMAP_H
+#include "byte.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "type.h"
+
+/* An open-addressing hash map with keys and values stored inline in the slots.
+Every slot has a control byte, either HMAP_EMPTY or 7 bits of the key's hash,
+and lookups compare a whole group of control bytes at once (SSE2 or AVX2 when
+the compiler targets them, 8 bytes in a word otherwise). Slots are probed
+linearly, and erase shifts the following entries back instead of leaving
+tombstones. The map doubles when it is 7/8 full. */
+
+typedef size_t (*hmap_hash_t)(const void *key);
+
+typedef struct hmap_t hmap_t;
+struct hmap_t {
+    byte *ctrl;
+    byte *slots;
+    size_t capacity;
+    size_t size;
+    size_t key_size;
+    size_t value_size;
+    size_t value_offset;
+    size_t slot_size;
+    hmap_hash_t hash;
+    BinaryPred equal;
+};
+
+/* hash defaults to calc_fold_binary over the key bytes and equal to memcmp.
+n is the number of entries to make room for. */
+hmap_t *hmap_create(size_t key_size, size_t value_size, hmap_hash_t hash, BinaryPred equal, size_t n);
+
+void hmap_free(hmap_t *map);
+
+void hmap_clear(hmap_t *map);
+
+size_t hmap_size(const hmap_t *map);
+
+// Returns the value stored for key, or NULL.
+void *hmap_find(const hmap_t *map, const void *key);
+
+/* Returns the value slot of key. A new entry copies value in, unless value is
+NULL. An existing entry is left as it is, *inserted tells which happened. */
+void *hmap_insert(hmap_t *map, const void *key, const void *value, bool *inserted);
+
+bool hmap_erase(hmap_t *map, const void *key);
+
+/* Iterates over the entries, *pos starts at 0. Erasing while iterating may
+skip or repeat entries. */
+bool hmap_next(const hmap_t *map, size_t *pos, void **key, void **value);
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file pool.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "pool.h"
+#include "calc.h"
+#include <assert.h>
+
+// Fewest slots a default chunk holds, larger slots get a block of their own per chunk.
+#define MEM_POOL_MIN_SLOTS 8
+
+mem_pool_t *mem_pool_create(size_t size, size_t n) {
+  return mem_pool_create_aligned(size, n, MEM_ALIGNMENT);
+}
+
+mem_pool_t *mem_pool_create_aligned(size_t size, size_t n, size_t align) {
+  mem_heap_t *heap;
+  mem_pool_t *pool;
+
+  assert(size);
+  assert(calc_is_2pow(align) && align >= MEM_ALIGNMENT);
+
+  size = calc_align(max(size, sizeof(void *)), align);
+
+  /* A chunk fills a full-grown heap block after the padding for align, so
+  that each later block holds one chunk and little else. If only a few slots
+  fit, the chunk outgrows the block and the heap sizes a block to it. */
+  if (!n) {
+    n = max((MEM_BLOCK_STANDARD_SIZE - MEM_BLOCK_HEADER_SIZE - (align - MEM_ALIGNMENT)) / size, MEM_POOL_MIN_SLOTS);
+  }
+
+  heap = mem_heap_create(sizeof(mem_pool_t) + n * size + align);
+
+  pool = mem_heap_alloc(heap, sizeof(mem_pool_t));
+  pool->heap = heap;
+  pool->heap_top = mem_heap_get_heap_top(heap);
+  pool->size = size;
+  pool->align = align;
+  pool->n_per_chunk = n;
+  pool->chunk_free = NULL;
+  pool->chunk_end = NULL;
+  pool->free_list = NULL;
+  pool->n_used = 0;
+  pool->n_free = 0;
+  pool->n_total = 0;
+  pool->peak_used = 0;
+
+  return pool;
+}
+
+void mem_pool_free(mem_pool_t *pool) {
+  assert(pool);
+  mem_heap_free(pool->heap);
+}
+
+void *mem_pool_alloc(mem_pool_t *pool) {
+  void *ptr;
+
+  assert(pool);
+
+  if (pool->free_list != NULL) {
+    ptr = pool->free_list;
+    pool->free_list = *(void **)ptr;
+    pool->n_free--;
+  } else {
+    if (pool->chunk_free == pool->chunk_end) {
+      pool->chunk_free = mem_heap_alloc_aligned(pool->heap, pool->n_per_chunk * pool->size, pool->align);
+      pool->chunk_end = pool->chunk_free + pool->n_per_chunk * pool->size;
+    }
+
+    ptr = pool->chunk_free;
+    pool->chunk_free += pool->size;
+    pool->n_total++;
+  }
+
+  pool->n_used++;
+  pool->peak_used = max(pool->peak_used, pool->n_used);
+
+  return ptr;
+}
+
+void mem_pool_release(mem_pool_t *pool, void *ptr) {
+  assert(pool);
+  assert(ptr);
+  assert(pool->n_used > 0);
+
+  *(void **)ptr = pool->free_list;
+  pool->free_list = ptr;
+
+  pool->n_used--;
+  pool->n_free++;
+}
+
+void mem_pool_empty(mem_pool_t *pool) {
+  assert(pool);
+
+  mem_heap_free_heap_top(pool->heap, pool->heap_top);
+
+  pool->chunk_free = NULL;
+  pool->chunk_end = NULL;
+  pool->free_list = NULL;
+  pool->n_used = 0;
+  pool->n_free = 0;
+  pool->n_total = 0;
+}
+
+void mem_pool_get_stat(mem_pool_t *pool, mem_pool_stat_t *stat) {
+  assert(pool);
+  assert(stat);
+
+  stat->slot_size = pool->size;
+  stat->n_used = pool->n_used;
+  stat->n_free = pool->n_free;
+  stat->n_total = pool->n_total;
+  stat->peak_used = pool->peak_used;
+  stat->heap_size = mem_heap_get_size(pool->heap);
+}
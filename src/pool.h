@@ -0,0 +1,60 @@
+/**
+ * @file pool.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef POOL_H
+#define POOL_H
+#include "heap.h"
+
+/* A pool of same-size slots carved out of mem_heap_t blocks. Released slots go
+on an intrusive free list, the whole pool is released at once with
+mem_pool_empty or mem_pool_free. */
+typedef struct mem_pool_t mem_pool_t;
+struct mem_pool_t {
+    mem_heap_t *heap;
+    byte *heap_top;
+    size_t size;
+    size_t align;
+    size_t n_per_chunk;
+    byte *chunk_free;
+    byte *chunk_end;
+    void *free_list;
+    size_t n_used;
+    size_t n_free;
+    size_t n_total;
+    size_t peak_used;
+};
+
+typedef struct mem_pool_stat_t mem_pool_stat_t;
+struct mem_pool_stat_t {
+    size_t slot_size;
+    size_t n_used;
+    size_t n_free;
+    size_t n_total;
+    size_t peak_used;
+    size_t heap_size;
+};
+
+// n is the number of slots carved per chunk, 0 picks a default.
+mem_pool_t *mem_pool_create(size_t size, size_t n);
+
+// Slots start at multiples of align, a power of two not smaller than MEM_ALIGNMENT.
+mem_pool_t *mem_pool_create_aligned(size_t size, size_t n, size_t align);
+
+void mem_pool_free(mem_pool_t *pool);
+
+void *mem_pool_alloc(mem_pool_t *pool);
+
+void mem_pool_release(mem_pool_t *pool, void *ptr);
+
+// Releases every slot, keeping the pool usable.
+void mem_pool_empty(mem_pool_t *pool);
+
+void mem_pool_get_stat(mem_pool_t *pool, mem_pool_stat_t *stat);
+
+#define MEM_POOL_CREATE(TYPE, N) mem_pool_create(sizeof(TYPE), (N))
+
+#define MEM_POOL_ALLOC(TYPE, POOL) ((TYPE *)mem_pool_alloc(POOL))
+
+#endif
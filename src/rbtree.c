@@ -0,0 +1,499 @@
+#include "rbtree.h"
+#include <assert.h>
+#include <stdlib.h>
+
+static void rbt_init_header(rbt_t *tree) {
+    tree->header->color = rbt_red;
+    tree->header->parent = NULL;
+    tree->header->left = tree->header;
+    tree->header->right = tree->header;
+    tree->header->size = 0;
+    tree->header->value = NULL;
+    tree->count = 0;
+}
+
+void rbt_init(rbt_t *tree, Compare comp) {
+    rbt_init_intrusive(tree, comp);
+    tree->pool = MEM_POOL_CREATE(rbt_node_t, 0);
+}
+
+void rbt_init_intrusive(rbt_t *tree, Compare comp) {
+    assert(comp);
+    tree->header = malloc(sizeof(rbt_node_t));
+    assert(tree->header);
+    tree->comp = comp;
+    tree->pool = NULL;
+    rbt_init_header(tree);
+}
+
+void rbt_destroy(rbt_t *tree) {
+    if (tree->pool != NULL)
+        mem_pool_free(tree->pool);
+    free(tree->header);
+}
+
+void rbt_clear(rbt_t *tree) {
+    if (tree->pool != NULL)
+        mem_pool_empty(tree->pool);
+    rbt_init_header(tree);
+}
+
+bool rbt_empty(rbt_t *tree) {
+    return tree->count == 0;
+}
+
+size_t rbt_size(rbt_t *tree) {
+    return tree->count;
+}
+
+rbt_node_t *rbt_begin(rbt_t *tree) {
+    return tree->header->left;
+}
+
+rbt_node_t *rbt_end(rbt_t *tree) {
+    return tree->header;
+}
+
+// Every node knows the size of its subtree, rotations and relinks keep it.
+static size_t rbt_size_of(rbt_node_t *x) {
+    return x == NULL ? 0 : x->size;
+}
+
+static rbt_node_t *rbt_minimum(rbt_node_t *x) {
+    while (x->left != NULL)
+        x = x->left;
+    return x;
+}
+
+static rbt_node_t *rbt_maximum(rbt_node_t *x) {
+    while (x->right != NULL)
+        x = x->right;
+    return x;
+}
+
+rbt_node_t *rbt_next(rbt_node_t *x) {
+    rbt_node_t *y;
+    if (x->right != NULL)
+        return rbt_minimum(x->right);
+    y = x->parent;
+    while (x == y->right) {
+        x = y;
+        y = y->parent;
+    }
+    // x is the header when the root has no right child
+    if (x->right != y)
+        x = y;
+    return x;
+}
+
+rbt_node_t *rbt_prev(rbt_node_t *x) {
+    rbt_node_t *y;
+    // only the header is red with its parent's parent being itself
+    if (x->color == rbt_red && x->parent != NULL && x->parent->parent == x)
+        return x->right;
+    if (x->left != NULL)
+        return rbt_maximum(x->left);
+    y = x->parent;
+    while (x == y->left) {
+        x = y;
+        y = y->parent;
+    }
+    return y;
+}
+
+static void rbt_rotate_left(rbt_node_t *x, rbt_node_t **root) {
+    rbt_node_t *y = x->right;
+    x->right = y->left;
+    if (y->left != NULL)
+        y->left->parent = x;
+    y->parent = x->parent;
+    if (x == *root)
+        *root = y;
+    else if (x == x->parent->left)
+        x->parent->left = y;
+    else
+        x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+    y->size = x->size;
+    x->size = rbt_size_of(x->left) + rbt_size_of(x->right) + 1;
+}
+
+static void rbt_rotate_right(rbt_node_t *x, rbt_node_t **root) {
+    rbt_node_t *y = x->left;
+    x->left = y->right;
+    if (y->right != NULL)
+        y->right->parent = x;
+    y->parent = x->parent;
+    if (x == *root)
+        *root = y;
+    else if (x == x->parent->right)
+        x->parent->right = y;
+    else
+        x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+    y->size = x->size;
+    x->size = rbt_size_of(x->left) + rbt_size_of(x->right) + 1;
+}
+
+static void rbt_rebalance(rbt_node_t *x, rbt_node_t **root) {
+    rbt_node_t *y;
+    x->color = rbt_red;
+    while (x != *root && x->parent->color == rbt_red) {
+        if (x->parent == x->parent->parent->left) {
+            y = x->parent->parent->right;
+            if (y != NULL && y->color == rbt_red) {
+                x->parent->color = rbt_black;
+                y->color = rbt_black;
+                x->parent->parent->color = rbt_red;
+                x = x->parent->parent;
+            } else {
+                if (x == x->parent->right) {
+                    x = x->parent;
+                    rbt_rotate_left(x, root);
+                }
+                x->parent->color = rbt_black;
+                x->parent->parent->color = rbt_red;
+                rbt_rotate_right(x->parent->parent, root);
+            }
+        } else {
+            y = x->parent->parent->left;
+            if (y != NULL && y->color == rbt_red) {
+                x->parent->color = rbt_black;
+                y->color = rbt_black;
+                x->parent->parent->color = rbt_red;
+                x = x->parent->parent;
+            } else {
+                if (x == x->parent->left) {
+                    x = x->parent;
+                    rbt_rotate_right(x, root);
+                }
+                x->parent->color = rbt_black;
+                x->parent->parent->color = rbt_red;
+                rbt_rotate_left(x->parent->parent, root);
+            }
+        }
+    }
+    (*root)->color = rbt_black;
+}
+
+/* Unlinks z and restores the colors, z ends up detached and the leftmost
+and rightmost of the header are kept up to date. */
+static void rbt_rebalance_for_erase(rbt_node_t *z, rbt_node_t *header) {
+    rbt_node_t **root = &header->parent;
+    rbt_node_t *y = z;
+    rbt_node_t *x = NULL;
+    rbt_node_t *x_parent = NULL;
+    rbt_node_t *w;
+    rbt_color_t color;
+
+    if (y->left == NULL)
+        x = y->right;
+    else if (y->right == NULL)
+        x = y->left;
+    else {
+        y = rbt_minimum(y->right);
+        x = y->right;
+    }
+
+    // y is the node leaving its place, every ancestor loses one
+    for (w = y->parent; w != header; w = w->parent)
+        --w->size;
+
+    if (y != z) {
+        // y is the successor of z and takes its place
+        z->left->parent = y;
+        y->left = z->left;
+        if (y != z->right) {
+            x_parent = y->parent;
+            if (x != NULL)
+                x->parent = y->parent;
+            y->parent->left = x;
+            y->right = z->right;
+            z->right->parent = y;
+        } else
+            x_parent = y;
+        if (*root == z)
+            *root = y;
+        else if (z->parent->left == z)
+            z->parent->left = y;
+        else
+            z->parent->right = y;
+        y->parent = z->parent;
+        y->size = z->size;
+        color = y->color;
+        y->color = z->color;
+        z->color = color;
+        y = z;
+    } else {
+        x_parent = y->parent;
+        if (x != NULL)
+            x->parent = y->parent;
+        if (*root == z)
+            *root = x;
+        else if (z->parent->left == z)
+            z->parent->left = x;
+        else
+            z->parent->right = x;
+        if (header->left == z)
+            header->left = z->right == NULL ? z->parent : rbt_minimum(x);
+        if (header->right == z)
+            header->right = z->left == NULL ? z->parent : rbt_maximum(x);
+    }
+
+    if (y->color == rbt_red)
+        return;
+
+    while (x != *root && (x == NULL || x->color == rbt_black)) {
+        if (x == x_parent->left) {
+            w = x_parent->right;
+            if (w->color == rbt_red) {
+                w->color = rbt_black;
+                x_parent->color = rbt_red;
+                rbt_rotate_left(x_parent, root);
+                w = x_parent->right;
+            }
+            if ((w->left == NULL || w->left->color == rbt_black) &&
+                (w->right == NULL || w->right->color == rbt_black)) {
+                w->color = rbt_red;
+                x = x_parent;
+                x_parent = x_parent->parent;
+            } else {
+                if (w->right == NULL || w->right->color == rbt_black) {
+                    if (w->left != NULL)
+                        w->left->color = rbt_black;
+                    w->color = rbt_red;
+                    rbt_rotate_right(w, root);
+                    w = x_parent->right;
+                }
+                w->color = x_parent->color;
+                x_parent->color = rbt_black;
+                if (w->right != NULL)
+                    w->right->color = rbt_black;
+                rbt_rotate_left(x_parent, root);
+                break;
+            }
+        } else {
+            w = x_parent->left;
+            if (w->color == rbt_red) {
+                w->color = rbt_black;
+                x_parent->color = rbt_red;
+                rbt_rotate_right(x_parent, root);
+                w = x_parent->left;
+            }
+            if ((w->right == NULL || w->right->color == rbt_black) &&
+                (w->left == NULL || w->left->color == rbt_black)) {
+                w->color = rbt_red;
+                x = x_parent;
+                x_parent = x_parent->parent;
+            } else {
+                if (w->left == NULL || w->left->color == rbt_black) {
+                    if (w->right != NULL)
+                        w->right->color = rbt_black;
+                    w->color = rbt_red;
+                    rbt_rotate_left(w, root);
+                    w = x_parent->left;
+                }
+                w->color = x_parent->color;
+                x_parent->color = rbt_black;
+                if (w->left != NULL)
+                    w->left->color = rbt_black;
+                rbt_rotate_right(x_parent, root);
+                break;
+            }
+        }
+    }
+    if (x != NULL)
+        x->color = rbt_black;
+}
+
+// Links z below y, on the left if x is set or z is less than y.
+static rbt_node_t *rbt_insert_at(rbt_t *tree, rbt_node_t *x, rbt_node_t *y, rbt_node_t *z) {
+    rbt_node_t *header = tree->header;
+
+    if (y == header || x != NULL || tree->comp(z->value, y->value)) {
+        y->left = z;
+        if (y == header) {
+            header->parent = z;
+            header->right = z;
+        } else if (y == header->left)
+            header->left = z;
+    } else {
+        y->right = z;
+        if (y == header->right)
+            header->right = z;
+    }
+    z->parent = y;
+    z->left = NULL;
+    z->right = NULL;
+    z->size = 1;
+    for (; y != header; y = y->parent)
+        ++y->size;
+    rbt_rebalance(z, &header->parent);
+    ++tree->count;
+    return z;
+}
+
+/* Finds where value goes, returns the equal node if there is one and
+unique is set, otherwise NULL with the parent in *y. */
+static rbt_node_t *rbt_find_insert_pos(rbt_t *tree, const void *value, bool unique, rbt_node_t **y) {
+    rbt_node_t *x = tree->header->parent;
+    rbt_node_t *j;
+    bool less = true;
+
+    *y = tree->header;
+    while (x != NULL) {
+        *y = x;
+        less = tree->comp(value, x->value);
+        x = less ? x->left : x->right;
+    }
+    if (!unique)
+        return NULL;
+
+    j = *y;
+    if (less) {
+        if (j == rbt_begin(tree))
+            return NULL;
+        j = rbt_prev(j);
+    }
+    return tree->comp(j->value, value) ? NULL : j;
+}
+
+rbt_node_t *rbt_insert_node_unique(rbt_t *tree, rbt_node_t *node, void *value, bool *inserted) {
+    rbt_node_t *y;
+    rbt_node_t *j = rbt_find_insert_pos(tree, value, true, &y);
+
+    if (inserted != NULL)
+        *inserted = j == NULL;
+    if (j != NULL)
+        return j;
+    node->value = value;
+    return rbt_insert_at(tree, NULL, y, node);
+}
+
+rbt_node_t *rbt_insert_node_equal(rbt_t *tree, rbt_node_t *node, void *value) {
+    rbt_node_t *y;
+
+    rbt_find_insert_pos(tree, value, false, &y);
+    node->value = value;
+    return rbt_insert_at(tree, NULL, y, node);
+}
+
+rbt_node_t *rbt_insert_unique(rbt_t *tree, void *value, bool *inserted) {
+    rbt_node_t *y;
+    rbt_node_t *j;
+
+    assert(tree->pool != NULL);
+    j = rbt_find_insert_pos(tree, value, true, &y);
+    if (inserted != NULL)
+        *inserted = j == NULL;
+    if (j != NULL)
+        return j;
+    j = MEM_POOL_ALLOC(rbt_node_t, tree->pool);
+    j->value = value;
+    return rbt_insert_at(tree, NULL, y, j);
+}
+
+rbt_node_t *rbt_insert_equal(rbt_t *tree, void *value) {
+    assert(tree->pool != NULL);
+    return rbt_insert_node_equal(tree, MEM_POOL_ALLOC(rbt_node_t, tree->pool), value);
+}
+
+rbt_node_t *rbt_erase(rbt_t *tree, rbt_node_t *node) {
+    rbt_node_t *next;
+
+    assert(node != tree->header);
+    next = rbt_next(node);
+    rbt_rebalance_for_erase(node, tree->header);
+    if (tree->pool != NULL)
+        mem_pool_release(tree->pool, node);
+    --tree->count;
+    return next;
+}
+
+size_t rbt_remove(rbt_t *tree, const void *value) {
+    rbt_node_t *first = rbt_lower_bound(tree, value);
+    rbt_node_t *last = rbt_upper_bound(tree, value);
+    size_t n = 0;
+
+    while (first != last) {
+        first = rbt_erase(tree, first);
+        ++n;
+    }
+    return n;
+}
+
+rbt_node_t *rbt_find(rbt_t *tree, const void *value) {
+    rbt_node_t *j = rbt_lower_bound(tree, value);
+    if (j == tree->header || tree->comp(value, j->value))
+        return tree->header;
+    return j;
+}
+
+rbt_node_t *rbt_lower_bound(rbt_t *tree, const void *value) {
+    rbt_node_t *y = tree->header;
+    rbt_node_t *x = tree->header->parent;
+    while (x != NULL) {
+        if (!tree->comp(x->value, value)) {
+            y = x;
+            x = x->left;
+        } else
+            x = x->right;
+    }
+    return y;
+}
+
+rbt_node_t *rbt_upper_bound(rbt_t *tree, const void *value) {
+    rbt_node_t *y = tree->header;
+    rbt_node_t *x = tree->header->parent;
+    while (x != NULL) {
+        if (tree->comp(value, x->value)) {
+            y = x;
+            x = x->left;
+        } else
+            x = x->right;
+    }
+    return y;
+}
+
+rbt_node_t *rbt_select(rbt_t *tree, size_t k) {
+    rbt_node_t *x = tree->header->parent;
+    size_t left;
+    while (x != NULL) {
+        left = rbt_size_of(x->left);
+        if (k < left)
+            x = x->left;
+        else if (k == left)
+            return x;
+        else {
+            k -= left + 1;
+            x = x->right;
+        }
+    }
+    return tree->header;
+}
+
+size_t rbt_rank(rbt_t *tree, const void *value) {
+    rbt_node_t *x = tree->header->parent;
+    size_t rank = 0;
+    while (x != NULL) {
+        if (tree->comp(x->value, value)) {
+            rank += rbt_size_of(x->left) + 1;
+            x = x->right;
+        } else
+            x = x->left;
+    }
+    return rank;
+}
+
+size_t rbt_node_rank(rbt_t *tree, rbt_node_t *node) {
+    size_t rank;
+    if (node == tree->header)
+        return tree->count;
+    rank = rbt_size_of(node->left);
+    for (; node->parent != tree->header; node = node->parent)
+        if (node == node->parent->right)
+            rank += rbt_size_of(node->parent->left) + 1;
+    return rank;
+}
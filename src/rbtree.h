@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "type.h"
+#include "pool.h"
 
 typedef bool rbt_color_t;
 #define rbt_red false
@@ -14,17 +15,76 @@ struct rbt_node_t {
     rbt_node_t *parent;
     rbt_node_t *left;
     rbt_node_t *right;
+    size_t size;
     void *value;
 };
 
+/* The header is a sentinel whose parent is the root, left the leftmost and
+right the rightmost node, it is also the end of the in-order iteration.
+Nodes come from pool, or for an intrusive tree are embedded in the values
+by the caller and pool is NULL. */
 typedef struct rbt_t rbt_t;
 struct rbt_t {
     rbt_node_t *header;
     size_t count;
     Compare comp;
+    mem_pool_t *pool;
 };
 
+void rbt_init(rbt_t *tree, Compare comp);
 
+// Nodes are passed to rbt_insert_node_*, the tree never allocates or frees one.
+void rbt_init_intrusive(rbt_t *tree, Compare comp);
 
+void rbt_destroy(rbt_t *tree);
 
-#endif
\ No newline at end of file
+void rbt_clear(rbt_t *tree);
+
+bool rbt_empty(rbt_t *tree);
+
+size_t rbt_size(rbt_t *tree);
+
+rbt_node_t *rbt_begin(rbt_t *tree);
+
+rbt_node_t *rbt_end(rbt_t *tree);
+
+rbt_node_t *rbt_next(rbt_node_t *node);
+
+rbt_node_t *rbt_prev(rbt_node_t *node);
+
+// Returns the node holding value, or the existing equal node with *inserted false.
+rbt_node_t *rbt_insert_unique(rbt_t *tree, void *value, bool *inserted);
+
+rbt_node_t *rbt_insert_equal(rbt_t *tree, void *value);
+
+rbt_node_t *rbt_insert_node_unique(rbt_t *tree, rbt_node_t *node, void *value, bool *inserted);
+
+rbt_node_t *rbt_insert_node_equal(rbt_t *tree, rbt_node_t *node, void *value);
+
+// Returns the node after the erased one.
+rbt_node_t *rbt_erase(rbt_t *tree, rbt_node_t *node);
+
+// Erases every node equal to value, returns how many.
+size_t rbt_remove(rbt_t *tree, const void *value);
+
+rbt_node_t *rbt_find(rbt_t *tree, const void *value);
+
+// First node not less than value.
+rbt_node_t *rbt_lower_bound(rbt_t *tree, const void *value);
+
+// First node greater than value.
+rbt_node_t *rbt_upper_bound(rbt_t *tree, const void *value);
+
+// Node with k nodes before it in order, the end if k is not less than the size.
+rbt_node_t *rbt_select(rbt_t *tree, size_t k);
+
+// Number of nodes less than value.
+size_t rbt_rank(rbt_t *tree, const void *value);
+
+// Number of nodes before node in order.
+size_t rbt_node_rank(rbt_t *tree, rbt_node_t *node);
+
+#define RBT_FOREACH(NODE, TREE) \
+    for ((NODE) = rbt_begin(TREE); (NODE) != rbt_end(TREE); (NODE) = rbt_next(NODE))
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file scratch.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "scratch.h"
+#include <assert.h>
+#include <pthread.h>
+
+#define SCRATCH_START_SIZE 4096
+
+static pthread_key_t scratch_key;
+static pthread_once_t scratch_once = PTHREAD_ONCE_INIT;
+
+static __thread mem_heap_t *scratch_heap = NULL;
+static __thread size_t scratch_depth = 0;
+
+// Frees the heap of an exiting thread.
+static void scratch_destroy(void *heap) {
+  mem_heap_free((mem_heap_t *)heap);
+}
+
+static void scratch_init(void) {
+  int ret = pthread_key_create(&scratch_key, scratch_destroy);
+  assert(ret == 0);
+}
+
+static void scratch_set_heap(mem_heap_t *heap) {
+  int ret;
+
+  scratch_heap = heap;
+
+  ret = pthread_setspecific(scratch_key, heap);
+  assert(ret == 0);
+}
+
+byte *scratch_begin(void) {
+  if (scratch_heap == NULL) {
+    pthread_once(&scratch_once, scratch_init);
+    scratch_set_heap(mem_heap_create_func(SCRATCH_START_SIZE, MEM_HEAP_DYNAMIC, "scratch"));
+  }
+
+  scratch_depth++;
+
+  return mem_heap_get_heap_top(scratch_heap);
+}
+
+/* Moves the top of the heap back to mark but keeps the blocks added after
+it, emptied, so that the next scope at this depth finds them again. */
+static void scratch_rewind(mem_heap_t *heap, byte *mark) {
+  mem_block_t *block = LIST_GET_LAST(heap->base);
+
+  while ((byte *)block > mark || (byte *)block + block->free < mark) {
+    block->free = block->start;
+    block = LIST_GET_PREV(list, block);
+    assert(block != NULL);
+  }
+
+  block->free = mark - (byte *)block;
+
+  assert(block->start <= block->free);
+}
+
+void scratch_end(byte *mark) {
+  size_t size;
+
+  assert(scratch_depth > 0);
+
+  scratch_depth--;
+
+  if (scratch_depth > 0) {
+    scratch_rewind(scratch_heap, mark);
+  } else if (LIST_GET_LEN(scratch_heap->base) > 1) {
+    size = scratch_heap->info->peak_size;
+    mem_heap_free(scratch_heap);
+    scratch_set_heap(mem_heap_create_func(size, MEM_HEAP_DYNAMIC, "scratch"));
+  } else {
+    mem_heap_free_heap_top(scratch_heap, mark);
+  }
+}
+
+mem_heap_t *scratch_get_heap(void) {
+  assert(scratch_depth > 0);
+  return scratch_heap;
+}
+
+void *scratch_alloc(size_t n) {
+  assert(scratch_depth > 0);
+  return mem_heap_alloc(scratch_heap, n);
+}
+
+void *scratch_alloc_aligned(size_t n, size_t align) {
+  assert(scratch_depth > 0);
+  return mem_heap_alloc_aligned(scratch_heap, n, align);
+}
@@ -0,0 +1,28 @@
+/**
+ * @file scratch.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef SCRATCH_H
+#define SCRATCH_H
+#include "heap.h"
+
+/* Per-thread scratch memory for the temporary buffers of a call. A scope is
+opened with scratch_begin and everything allocated inside it is released by
+the matching scratch_end. Scopes nest. An inner scope gives its memory back
+to the enclosing one but keeps the blocks it added. When the outermost scope
+ends after the heap had to grow, the heap is rebuilt as one block of its peak
+size, so that later scopes run without touching malloc. */
+
+byte *scratch_begin(void);
+
+void scratch_end(byte *mark);
+
+// The heap of the calling thread, only valid inside a scope.
+mem_heap_t *scratch_get_heap(void);
+
+void *scratch_alloc(size_t n);
+
+void *scratch_alloc_aligned(size_t n, size_t align);
+
+#endif
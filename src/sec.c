@@ -5,12 +5,19 @@
  */
 #include "sec.h"
 #include <assert.h>
+#include <stddef.h>
 
 void timeval_now(struct timeval *tv) {
   int ret = gettimeofday(tv, NULL);
   assert(ret == 0);
 }
 
+usec_t usec_now(void) {
+  struct timeval tv;
+  timeval_now(&tv);
+  return (usec_t)tv.tv_sec * USEC_PER_SEC + tv.tv_usec;
+}
+
 void timeval_from_usec(struct timeval *tv, usec_t usec) {
   tv->tv_sec = usec / USEC_PER_SEC;
   tv->tv_usec = usec % USEC_PER_SEC;
@@ -23,6 +23,9 @@ typedef unsigned long int nsec_t;
 
 void timeval_now(struct timeval *tv);
 
+// Wall clock time in microseconds since the epoch.
+usec_t usec_now(void);
+
 void timeval_from_usec(struct timeval *tv, usec_t usec);
 
 void timeval_add_usec(struct timeval *tv, usec_t usec);
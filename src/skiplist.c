@@ -0,0 +1,335 @@
+/**
+ * @file skiplist.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "skiplist.h"
+#include <assert.h>
+
+#define SKL_MARK ((uintptr_t)1)
+
+#define skl_is_marked(P) (((P) & SKL_MARK) != 0)
+#define skl_unmark(P) ((skl_node_t *)((P) & ~SKL_MARK))
+
+static __thread uint64_t skl_seed = 0;
+
+static inline uintptr_t skl_load(skl_node_t *node, size_t level) {
+  return __atomic_load_n(&node->next[level], __ATOMIC_ACQUIRE);
+}
+
+static inline bool skl_cas(skl_node_t *node, size_t level, uintptr_t expected, uintptr_t desired) {
+  return __atomic_compare_exchange_n(&node->next[level], &expected, desired, false, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE);
+}
+
+// Level count with P(n) = 4^-(n - 1), from a per-thread xorshift.
+static size_t skl_random_level(void) {
+  uint64_t r;
+  size_t n = 1;
+
+  if (skl_seed == 0) {
+    skl_seed = (uintptr_t)&skl_seed | 1;
+  }
+  skl_seed ^= skl_seed << 13;
+  skl_seed ^= skl_seed >> 7;
+  skl_seed ^= skl_seed << 17;
+
+  for (r = skl_seed; n < SKL_MAX_LEVEL && (r & 3) == 0; r >>= 2) {
+    n++;
+  }
+  return n;
+}
+
+/* Pops a node off the free stack of its height. The caller is inside
+ebr_enter and nodes only go back a grace period after they were retired, so
+a node read as top cannot be popped and pushed again before the CAS. */
+static skl_node_t *skl_node_alloc(skl_t *list, size_t n_levels) {
+  skl_node_t *node = __atomic_load_n(&list->free[n_levels], __ATOMIC_ACQUIRE);
+
+  while (node != NULL &&
+         !__atomic_compare_exchange_n(&list->free[n_levels], &node,
+                                      (skl_node_t *)__atomic_load_n(&node->next[0], __ATOMIC_RELAXED), false,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+  }
+
+  if (node == NULL) {
+    node = (skl_node_t *)mem_arena_alloc(list->arena, sizeof(skl_node_t) + n_levels * sizeof(uintptr_t));
+    node->n_levels = (uint32_t)n_levels;
+  }
+
+  return node;
+}
+
+// Called by ebr once no thread can reach node, pushes it on the free stack.
+static void skl_node_recycle(void *ptr, void *arg) {
+  skl_t *list = (skl_t *)arg;
+  skl_node_t *node = (skl_node_t *)ptr;
+  skl_node_t *top = __atomic_load_n(&list->free[node->n_levels], __ATOMIC_RELAXED);
+
+  do {
+    __atomic_store_n(&node->next[0], (uintptr_t)top, __ATOMIC_RELAXED);
+  } while (!__atomic_compare_exchange_n(&list->free[node->n_levels], &top, node, false, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED));
+}
+
+/* The inserting thread and the removing thread each hold a reference, the
+last one to drop it retires the node. */
+static void skl_node_release(skl_t *list, skl_node_t *node) {
+  if (__atomic_sub_fetch(&node->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    ebr_retire_arg(node, skl_node_recycle, list);
+  }
+}
+
+void skl_init(skl_t *list, Compare comp) {
+  size_t i;
+
+  assert(comp);
+
+  list->comp = comp;
+  list->arena = mem_arena_create(0);
+  for (i = 0; i <= SKL_MAX_LEVEL; i++) {
+    list->free[i] = NULL;
+  }
+  list->count = 0;
+
+  list->head = (skl_node_t *)mem_arena_alloc(list->arena, sizeof(skl_node_t) + SKL_MAX_LEVEL * sizeof(uintptr_t));
+  list->head->value = NULL;
+  list->head->n_levels = SKL_MAX_LEVEL;
+  list->head->refs = 0;
+  for (i = 0; i < SKL_MAX_LEVEL; i++) {
+    list->head->next[i] = 0;
+  }
+}
+
+void skl_destroy(skl_t *list) {
+  ebr_synchronize();
+  mem_arena_free(list->arena);
+}
+
+/* Fills preds and succs around value at every level, unlinking marked
+nodes on the way, and tells if succs[0] holds an equal value. */
+static bool skl_search(skl_t *list, const void *value, skl_node_t **preds, skl_node_t **succs) {
+  skl_node_t *pred;
+  skl_node_t *curr;
+  uintptr_t succ;
+  size_t level;
+
+retry:
+  pred = list->head;
+  for (level = SKL_MAX_LEVEL; level-- > 0;) {
+    curr = skl_unmark(skl_load(pred, level));
+    while (curr != NULL) {
+      succ = skl_load(curr, level);
+      if (skl_is_marked(succ)) {
+        if (!skl_cas(pred, level, (uintptr_t)curr, (uintptr_t)skl_unmark(succ))) {
+          goto retry;
+        }
+        curr = skl_unmark(succ);
+      } else if (list->comp(curr->value, value)) {
+        pred = curr;
+        curr = skl_unmark(succ);
+      } else {
+        break;
+      }
+    }
+    preds[level] = pred;
+    succs[level] = curr;
+  }
+
+  return curr != NULL && !list->comp(value, curr->value);
+}
+
+/* Unlinks a marked node from every level. Unlike skl_search it walks past
+nodes equal to it, a new node with the same value may sit in front of it at
+levels it was linked at late. */
+static void skl_unlink(skl_t *list, skl_node_t *node) {
+  skl_node_t *pred;
+  skl_node_t *curr;
+  uintptr_t succ;
+  size_t level;
+
+retry:
+  pred = list->head;
+  for (level = SKL_MAX_LEVEL; level-- > 0;) {
+    curr = skl_unmark(skl_load(pred, level));
+    while (curr != NULL) {
+      succ = skl_load(curr, level);
+      if (skl_is_marked(succ)) {
+        if (!skl_cas(pred, level, (uintptr_t)curr, (uintptr_t)skl_unmark(succ))) {
+          goto retry;
+        }
+        curr = skl_unmark(succ);
+      } else if (!list->comp(node->value, curr->value)) {
+        pred = curr;
+        curr = skl_unmark(succ);
+      } else {
+        break;
+      }
+    }
+  }
+}
+
+bool skl_insert(skl_t *list, void *value) {
+  skl_node_t *preds[SKL_MAX_LEVEL];
+  skl_node_t *succs[SKL_MAX_LEVEL];
+  skl_node_t *node;
+  uintptr_t succ;
+  size_t n_levels = skl_random_level();
+  size_t level;
+
+  ebr_enter();
+
+  node = skl_node_alloc(list, n_levels);
+  node->value = value;
+  node->refs = 2;
+
+  for (;;) {
+    if (skl_search(list, value, preds, succs)) {
+      // never published, but a concurrent pop may still hold it as the old top
+      ebr_retire_arg(node, skl_node_recycle, list);
+      ebr_exit();
+      return false;
+    }
+    for (level = 0; level < n_levels; level++) {
+      __atomic_store_n(&node->next[level], (uintptr_t)succs[level], __ATOMIC_RELAXED);
+    }
+    if (skl_cas(preds[0], 0, (uintptr_t)succs[0], (uintptr_t)node)) {
+      break;
+    }
+  }
+
+  __atomic_fetch_add(&list->count, 1, __ATOMIC_RELAXED);
+
+  for (level = 1; level < n_levels; level++) {
+    for (;;) {
+      succ = skl_load(node, level);
+      if (skl_is_marked(succ)) {
+        goto done;
+      }
+      if (succ != (uintptr_t)succs[level] && !skl_cas(node, level, succ, (uintptr_t)succs[level])) {
+        // only a remover changes it, by marking
+        goto done;
+      }
+      if (skl_cas(preds[level], level, (uintptr_t)succs[level], (uintptr_t)node)) {
+        break;
+      }
+      skl_search(list, value, preds, succs);
+    }
+  }
+
+done:
+  // a remover may have unlinked the node before we linked its upper levels
+  if (skl_is_marked(skl_load(node, 0))) {
+    skl_unlink(list, node);
+  }
+  skl_node_release(list, node);
+
+  ebr_exit();
+  return true;
+}
+
+bool skl_remove(skl_t *list, const void *value) {
+  skl_node_t *preds[SKL_MAX_LEVEL];
+  skl_node_t *succs[SKL_MAX_LEVEL];
+  skl_node_t *node;
+  uintptr_t succ;
+  size_t level;
+
+  ebr_enter();
+
+  if (!skl_search(list, value, preds, succs)) {
+    ebr_exit();
+    return false;
+  }
+  node = succs[0];
+
+  for (level = node->n_levels; level-- > 1;) {
+    succ = skl_load(node, level);
+    while (!skl_is_marked(succ) && !skl_cas(node, level, succ, succ | SKL_MARK)) {
+      succ = skl_load(node, level);
+    }
+  }
+
+  // marking level 0 is the linearization point, only one remover wins
+  for (;;) {
+    succ = skl_load(node, 0);
+    if (skl_is_marked(succ)) {
+      ebr_exit();
+      return false;
+    }
+    if (skl_cas(node, 0, succ, succ | SKL_MARK)) {
+      break;
+    }
+  }
+
+  __atomic_fetch_sub(&list->count, 1, __ATOMIC_RELAXED);
+
+  skl_unlink(list, node);
+  skl_node_release(list, node);
+
+  ebr_exit();
+  return true;
+}
+
+// Wait-free, marked nodes are stepped over instead of unlinked.
+static skl_node_t *skl_lower_bound_low(skl_t *list, const void *value) {
+  skl_node_t *pred = list->head;
+  skl_node_t *curr = NULL;
+  uintptr_t succ;
+  size_t level;
+
+  for (level = SKL_MAX_LEVEL; level-- > 0;) {
+    curr = skl_unmark(skl_load(pred, level));
+    while (curr != NULL) {
+      succ = skl_load(curr, level);
+      if (skl_is_marked(succ)) {
+        curr = skl_unmark(succ);
+      } else if (list->comp(curr->value, value)) {
+        pred = curr;
+        curr = skl_unmark(succ);
+      } else {
+        break;
+      }
+    }
+  }
+
+  // the walk at level 0 ends on a node that was not marked when it was read
+  return curr;
+}
+
+void *skl_find(skl_t *list, const void *value) {
+  skl_node_t *node;
+  void *found = NULL;
+
+  ebr_enter();
+  node = skl_lower_bound_low(list, value);
+  if (node != NULL && !list->comp(value, node->value)) {
+    found = node->value;
+  }
+  ebr_exit();
+
+  return found;
+}
+
+size_t skl_size(skl_t *list) {
+  return __atomic_load_n(&list->count, __ATOMIC_RELAXED);
+}
+
+skl_node_t *skl_begin(skl_t *list) {
+  assert(ebr_in_critical());
+  return skl_next(list->head);
+}
+
+skl_node_t *skl_lower_bound(skl_t *list, const void *value) {
+  assert(ebr_in_critical());
+  return skl_lower_bound_low(list, value);
+}
+
+skl_node_t *skl_next(skl_node_t *node) {
+  assert(ebr_in_critical());
+  node = skl_unmark(skl_load(node, 0));
+  while (node != NULL && skl_is_marked(skl_load(node, 0))) {
+    node = skl_unmark(skl_load(node, 0));
+  }
+  return node;
+}
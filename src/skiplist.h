@@ -0,0 +1,68 @@
+/**
+ * @file skiplist.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+#include "arena.h"
+#include "ebr.h"
+#include "type.h"
+#include <stdint.h>
+
+#define SKL_MAX_LEVEL 24
+
+/* A lock-free ordered set of values compared with a Compare, values are
+unique. Nodes are linked with CAS; a node is deleted logically by marking
+the low bit of its next pointers, top level first, and unlinked by any later
+traversal. Lookups never write and never retry. Nodes come from an arena,
+are retired through ebr once both the inserting and the removing thread
+are done with them, and then pushed on a lock-free free stack per level
+count. */
+typedef struct skl_node_t skl_node_t;
+struct skl_node_t {
+    void *value;
+    uint32_t n_levels;
+    uint32_t refs;
+    uintptr_t next[];
+};
+
+typedef struct skl_t skl_t;
+struct skl_t {
+    skl_node_t *head;
+    Compare comp;
+    mem_arena_t *arena;
+    skl_node_t *free[SKL_MAX_LEVEL + 1];
+    size_t count __attribute__((aligned(CACHE_LINE_SIZE)));
+};
+
+void skl_init(skl_t *list, Compare comp);
+
+/* No thread may use the list any more, and every thread that inserted into
+or removed from it must have exited or called ebr_synchronize, since either
+may have retired nodes that go back to it. */
+void skl_destroy(skl_t *list);
+
+// Returns false if an equal value is there.
+bool skl_insert(skl_t *list, void *value);
+
+bool skl_remove(skl_t *list, const void *value);
+
+// Returns the stored value equal to value, or NULL.
+void *skl_find(skl_t *list, const void *value);
+
+size_t skl_size(skl_t *list);
+
+/* Iteration is weakly consistent, it sees values present for the whole
+scan and maybe ones inserted or removed meanwhile. It must run inside
+ebr_enter and ebr_exit, a NULL node is the end. */
+skl_node_t *skl_begin(skl_t *list);
+
+// First node not less than value.
+skl_node_t *skl_lower_bound(skl_t *list, const void *value);
+
+skl_node_t *skl_next(skl_node_t *node);
+
+#define SKL_FOREACH(NODE, LIST) for ((NODE) = skl_begin(LIST); (NODE) != NULL; (NODE) = skl_next(NODE))
+
+#endif
@@ -0,0 +1,239 @@
+/**
+ * @file wheel.c
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#include "wheel.h"
+#include "calc.h"
+#include <assert.h>
+#include <string.h>
+
+#define WHEEL_SPAN ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+static void wheel_add(wheel_list_t *list, wheel_timer_t *timer) {
+  LIST_ADD_LAST(link, *list, timer);
+  timer->list = list;
+}
+
+static void wheel_unlink(wheel_t *wheel, wheel_timer_t *timer) {
+  wheel_list_t *list = timer->list;
+  size_t i;
+
+  LIST_REMOVE(link, *list, timer);
+  timer->list = NULL;
+
+  if (list != &wheel->due && LIST_GET_LEN(*list) == 0) {
+    i = list - &wheel->slots[0][0];
+    wheel->occupied[i / WHEEL_SIZE] &= ~((uint64_t)1 << (i % WHEEL_SIZE));
+  }
+}
+
+// Puts timer, due at or after the current tick, in the slot for its distance.
+static void wheel_place(wheel_t *wheel, wheel_timer_t *timer) {
+  uint64_t expire = timer->expire;
+  uint64_t delta = expire - wheel->now;
+  size_t level = 0, slot;
+
+  if (delta >= WHEEL_SPAN) {
+    expire = wheel->now + WHEEL_SPAN - 1;
+    delta = WHEEL_SPAN - 1;
+  }
+
+  while (delta >> (WHEEL_BITS * (level + 1)) != 0) {
+    level++;
+  }
+
+  slot = (expire >> (WHEEL_BITS * level)) & WHEEL_MASK;
+  wheel_add(&wheel->slots[level][slot], timer);
+  wheel->occupied[level] |= (uint64_t)1 << slot;
+}
+
+static void wheel_schedule_low(wheel_t *wheel, wheel_timer_t *timer, uint64_t expire) {
+  if (timer->list != NULL) {
+    wheel_unlink(wheel, timer);
+  } else {
+    wheel->count++;
+  }
+
+  timer->expire = expire;
+
+  if (expire <= wheel->now) {
+    wheel_add(&wheel->due, timer);
+  } else {
+    wheel_place(wheel, timer);
+  }
+}
+
+// Moves the timers of list to expired.
+static size_t wheel_collect(wheel_t *wheel, wheel_list_t *list, wheel_list_t *expired) {
+  wheel_timer_t *timer;
+  size_t n = 0;
+
+  while ((timer = LIST_GET_FIRST(*list)) != NULL) {
+    wheel_unlink(wheel, timer);
+    LIST_ADD_LAST(link, *expired, timer);
+    n++;
+  }
+
+  wheel->count -= n;
+
+  return n;
+}
+
+/* Called when level 0 wraps around, moves the slot each higher level has
+reached down, going up as long as that level wraps around too. */
+static void wheel_cascade(wheel_t *wheel) {
+  wheel_list_t *list;
+  wheel_timer_t *timer;
+  size_t level, slot;
+
+  for (level = 1; level < WHEEL_LEVELS; level++) {
+    slot = (wheel->now >> (WHEEL_BITS * level)) & WHEEL_MASK;
+    list = &wheel->slots[level][slot];
+    while ((timer = LIST_GET_FIRST(*list)) != NULL) {
+      wheel_unlink(wheel, timer);
+      wheel_place(wheel, timer);
+    }
+    if (slot != 0) {
+      break;
+    }
+  }
+}
+
+void wheel_timer_init(wheel_timer_t *timer) {
+  timer->expire = 0;
+  timer->list = NULL;
+  LIST_NODE_INIT(link, timer);
+}
+
+void wheel_init(wheel_t *wheel, usec_t tick, usec_t start) {
+  assert(tick > 0);
+
+  memset(wheel, 0, sizeof(*wheel));
+  mutex_init(&wheel->mutex);
+  wheel->tick = tick;
+  wheel->start = start;
+  LIST_INIT(wheel->due);
+}
+
+void wheel_destroy(wheel_t *wheel) {
+  mutex_destroy(&wheel->mutex);
+}
+
+void wheel_schedule(wheel_t *wheel, wheel_timer_t *timer, usec_t expire) {
+  uint64_t ticks = 0;
+
+  if (expire > wheel->start) {
+    ticks = (expire - wheel->start + wheel->tick - 1) / wheel->tick;
+  }
+
+  mutex_lock(&wheel->mutex);
+  wheel_schedule_low(wheel, timer, ticks);
+  mutex_unlock(&wheel->mutex);
+}
+
+void wheel_schedule_after(wheel_t *wheel, wheel_timer_t *timer, usec_t timeout) {
+  mutex_lock(&wheel->mutex);
+  wheel_schedule_low(wheel, timer, wheel->now + (timeout + wheel->tick - 1) / wheel->tick);
+  mutex_unlock(&wheel->mutex);
+}
+
+bool wheel_cancel(wheel_t *wheel, wheel_timer_t *timer) {
+  bool scheduled;
+
+  mutex_lock(&wheel->mutex);
+  scheduled = timer->list != NULL;
+  if (scheduled) {
+    wheel_unlink(wheel, timer);
+    wheel->count--;
+  }
+  mutex_unlock(&wheel->mutex);
+
+  return scheduled;
+}
+
+/* Returns the first tick after now that reaches an occupied slot, or
+UINT64_MAX. That is the first occupied slot of a level after its current
+one, wrapping around. Above level 0 the slot is reached when it cascades,
+which is no later than its timers expire. Empty slots in between need no
+work, so advance jumps over them. */
+static uint64_t wheel_next_tick(wheel_t *wheel) {
+  uint64_t best = UINT64_MAX, block, base, cand, bits;
+  size_t level, slot;
+
+  for (level = 0; level < WHEEL_LEVELS; level++) {
+    if (wheel->occupied[level] == 0) {
+      continue;
+    }
+    block = wheel->now >> (WHEEL_BITS * level);
+    base = block & ~(uint64_t)WHEEL_MASK;
+    slot = block & WHEEL_MASK;
+    bits = slot == WHEEL_MASK ? 0 : wheel->occupied[level] & (~(uint64_t)0 << (slot + 1));
+    if (bits != 0) {
+      cand = base | __builtin_ctzll(bits);
+    } else {
+      cand = (base + WHEEL_SIZE) | __builtin_ctzll(wheel->occupied[level]);
+    }
+    best = min(best, cand << (WHEEL_BITS * level));
+  }
+
+  return best;
+}
+
+size_t wheel_advance(wheel_t *wheel, usec_t now, wheel_list_t *expired) {
+  uint64_t target = 0, next;
+  size_t n;
+
+  if (now > wheel->start) {
+    target = (now - wheel->start) / wheel->tick;
+  }
+
+  mutex_lock(&wheel->mutex);
+
+  n = wheel_collect(wheel, &wheel->due, expired);
+
+  while (wheel->now < target) {
+    next = wheel_next_tick(wheel);
+    if (next > target) {
+      wheel->now = target;
+      break;
+    }
+    wheel->now = next;
+    if ((next & WHEEL_MASK) == 0) {
+      wheel_cascade(wheel);
+    }
+    n += wheel_collect(wheel, &wheel->slots[0][next & WHEEL_MASK], expired);
+  }
+
+  mutex_unlock(&wheel->mutex);
+
+  return n;
+}
+
+bool wheel_next_expire(wheel_t *wheel, usec_t *expire) {
+  uint64_t next;
+
+  mutex_lock(&wheel->mutex);
+
+  if (wheel->count == 0) {
+    mutex_unlock(&wheel->mutex);
+    return false;
+  }
+
+  next = LIST_GET_LEN(wheel->due) != 0 ? wheel->now : wheel_next_tick(wheel);
+  *expire = wheel->start + next * wheel->tick;
+
+  mutex_unlock(&wheel->mutex);
+
+  return true;
+}
+
+size_t wheel_size(wheel_t *wheel) {
+  size_t count;
+
+  mutex_lock(&wheel->mutex);
+  count = wheel->count;
+  mutex_unlock(&wheel->mutex);
+
+  return count;
+}
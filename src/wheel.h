@@ -0,0 +1,81 @@
+/**
+ * @file wheel.h
+ * @date 2026-10-17
+ * @author yuesong-feng
+ */
+#ifndef WHEEL_H
+#define WHEEL_H
+#include "lst.h"
+#include "mutex.h"
+#include "sec.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+
+// Levels of the wheel, timers further than WHEEL_SIZE^WHEEL_LEVELS ticks wait at the top.
+#define WHEEL_LEVELS 6
+
+typedef struct wheel_timer_t wheel_timer_t;
+
+typedef LIST(wheel_timer_t) wheel_list_t;
+
+/* A timer is embedded in the object it times out. list is the slot holding
+it while scheduled, NULL otherwise. */
+struct wheel_timer_t {
+    uint64_t expire;
+    wheel_list_t *list;
+    LIST_NODE(wheel_timer_t) link;
+};
+
+/* A hierarchical timing wheel of WHEEL_LEVELS levels of WHEEL_SIZE slots.
+Level l holds the timers due in less than WHEEL_SIZE^(l+1) ticks, a slot of
+it spans WHEEL_SIZE^l ticks and is moved down a level when the lower levels
+wrap around to it. Schedule and cancel are O(1), one bitmap per level lets
+advance skip empty slots. Times are microseconds, rounded up to whole ticks
+so a timer never expires early. */
+typedef struct wheel_t wheel_t;
+struct wheel_t {
+    mutex_t mutex;
+    usec_t tick;
+    usec_t start;
+    uint64_t now;
+    size_t count;
+    wheel_list_t due;
+    uint64_t occupied[WHEEL_LEVELS];
+    wheel_list_t slots[WHEEL_LEVELS][WHEEL_SIZE];
+};
+
+void wheel_timer_init(wheel_timer_t *timer);
+
+// Time start is tick 0, times before it are due at once.
+void wheel_init(wheel_t *wheel, usec_t tick, usec_t start);
+
+// Pending timers are dropped, not reported.
+void wheel_destroy(wheel_t *wheel);
+
+// Schedules timer at the absolute time expire, a scheduled timer is moved.
+void wheel_schedule(wheel_t *wheel, wheel_timer_t *timer, usec_t expire);
+
+// Schedules timer timeout after the time the wheel was last advanced to.
+void wheel_schedule_after(wheel_t *wheel, wheel_timer_t *timer, usec_t timeout);
+
+/* Returns false if timer was not scheduled, including when it has expired
+and is waiting in a batch of wheel_advance. */
+bool wheel_cancel(wheel_t *wheel, wheel_timer_t *timer);
+
+/* Called by the driving thread. Advances the wheel to now and appends the
+expired timers to expired, earliest tick first, and returns their number.
+The timers are no longer scheduled, a timer must be removed from expired
+before it is scheduled again. */
+size_t wheel_advance(wheel_t *wheel, usec_t now, wheel_list_t *expired);
+
+/* Stores a time no later than the earliest expiry, the driving thread may
+sleep until then. Returns false if no timer is scheduled. */
+bool wheel_next_expire(wheel_t *wheel, usec_t *expire);
+
+size_t wheel_size(wheel_t *wheel);
+
+#endif
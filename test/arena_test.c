@@ -0,0 +1,47 @@
+#include "arena.h"
+#include "thread.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define N_THREADS 4
+#define N_ALLOCS 100000
+
+mem_arena_t *arena;
+uint64_t *ptrs[N_THREADS][N_ALLOCS];
+
+void *worker(void *arg) {
+  intptr_t id = (intptr_t)arg;
+  mem_arena_local_t local;
+
+  mem_arena_local_init(&local, arena, 0);
+
+  for (int i = 0; i < N_ALLOCS; ++i) {
+    if (i % 2) {
+      ptrs[id][i] = mem_arena_alloc(arena, sizeof(uint64_t) * (1 + i % 7));
+    } else {
+      ptrs[id][i] = mem_arena_local_alloc(&local, sizeof(uint64_t) * (1 + i % 5));
+    }
+    *ptrs[id][i] = (uint64_t)id << 32 | i;
+  }
+  return NULL;
+}
+
+int main(int argc, char const *argv[]) {
+  thread_t threads[N_THREADS];
+
+  arena = mem_arena_create(0);
+
+  for (intptr_t i = 0; i < N_THREADS; ++i)
+    threads[i] = thread_create(worker, (void *)i);
+  for (int i = 0; i < N_THREADS; ++i)
+    thread_join(threads[i]);
+
+  for (uint64_t id = 0; id < N_THREADS; ++id)
+    for (uint64_t i = 0; i < N_ALLOCS; ++i)
+      assert(*ptrs[id][i] == (id << 32 | i));
+
+  printf("arena size: %zu\n", mem_arena_get_size(arena));
+  mem_arena_free(arena);
+  return 0;
+}
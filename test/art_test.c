@@ -0,0 +1,242 @@
+#include "art.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N 50000
+#define MAX_LEN 40
+
+typedef struct entry_t entry_t;
+struct entry_t {
+  byte data[MAX_LEN];
+  size_t len;
+  bool present;
+};
+
+typedef struct scan_t scan_t;
+struct scan_t {
+  entry_t **keys;
+  size_t n;
+  size_t pos;
+};
+
+static entry_t keys[N];
+
+static int key_compare(const void *a, const void *b) {
+  const entry_t *x = *(entry_t *const *)a, *y = *(entry_t *const *)b;
+  size_t len = x->len < y->len ? x->len : y->len;
+  int cmp = memcmp(x->data, y->data, len);
+  return cmp != 0 ? cmp : (x->len > y->len) - (x->len < y->len);
+}
+
+// Checks that the keys come in the order of the reference scan.
+static int scan_callback(void *arg, const byte *key, size_t len, void *value) {
+  scan_t *scan = arg;
+  entry_t *expect;
+
+  assert(scan->pos < scan->n);
+  expect = scan->keys[scan->pos++];
+  assert(len == expect->len && memcmp(key, expect->data, len) == 0);
+  assert(value == expect);
+  return 0;
+}
+
+static int stop_callback(void *arg, const byte *key, size_t len, void *value) {
+  return ++*(int *)arg == 10 ? 7 : 0;
+}
+
+static bool has_prefix(const entry_t *key, const byte *prefix, size_t len) {
+  return key->len >= len && memcmp(key->data, prefix, len) == 0;
+}
+
+static bool in_range(const entry_t *key, const entry_t *lo, const entry_t *hi) {
+  return key_compare(&key, &lo) >= 0 && key_compare(&key, &hi) < 0;
+}
+
+// Builds the sorted list of present keys passing filter into scan.
+static void expect_keys(scan_t *scan, entry_t **sorted, size_t n, bool (*filter)(const entry_t *, void *), void *arg) {
+  scan->n = 0;
+  scan->pos = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (sorted[i]->present && (filter == NULL || filter(sorted[i], arg))) {
+      scan->keys[scan->n++] = sorted[i];
+    }
+  }
+}
+
+static bool prefix_filter(const entry_t *key, void *arg) {
+  const entry_t *prefix = arg;
+  return has_prefix(key, prefix->data, prefix->len);
+}
+
+static bool range_filter(const entry_t *key, void *arg) {
+  entry_t **bounds = arg;
+  return in_range(key, bounds[0], bounds[1]);
+}
+
+int main(int argc, char const *argv[]) {
+  static entry_t *sorted[N], *expect[N];
+  art_t tree;
+  scan_t scan = {expect, 0, 0};
+  void *value;
+  size_t n_present = 0;
+  int count;
+
+  // short keys over a small alphabet share prefixes and are prefixes of each other,
+  // a third of them start with a prefix longer than a node can hold
+  art_init(&tree);
+  srand(7);
+  for (int i = 0; i < N; i++) {
+    entry_t *key = &keys[i];
+    size_t start = 0;
+    if (i % 3 == 0) {
+      memcpy(key->data, "a_long_shared_prefix_", 21);
+      start = 21;
+    }
+    key->len = start + rand() % (MAX_LEN - start - 10);
+    for (size_t j = start; j < key->len; j++) {
+      key->data[j] = i % 5 == 0 ? (byte)(rand() % 256) : (byte)('a' + rand() % 4);
+    }
+    sorted[i] = key;
+  }
+  qsort(sorted, N, sizeof(entry_t *), key_compare);
+  for (int i = 0; i < N; i++) {
+    entry_t *key = sorted[i];
+    bool dup = i > 0 && key_compare(&sorted[i - 1], &key) == 0;
+    assert(art_insert(&tree, key->data, key->len, key) == !dup);
+    // a duplicate replaces the value, so the first copy is marked absent
+    if (dup) {
+      sorted[i - 1]->present = false;
+    } else {
+      n_present++;
+    }
+    key->present = true;
+  }
+  assert(art_size(&tree) == n_present);
+  printf("%zu keys\n", n_present);
+
+  for (int i = 0; i < N; i++) {
+    assert(art_find(&tree, keys[i].data, keys[i].len, &value));
+    assert(!keys[i].present || value == &keys[i]);
+  }
+  assert(!art_find(&tree, (const byte *)"zzzz", 4, NULL));
+  assert(!art_find(&tree, (const byte *)"a_long_shared_prefiy", 20, NULL));
+
+  // full scan in key order, then an early stop is passed up
+  expect_keys(&scan, sorted, N, NULL, NULL);
+  assert(art_iter(&tree, scan_callback, &scan) == 0 && scan.pos == scan.n);
+  count = 0;
+  assert(art_iter(&tree, stop_callback, &count) == 7 && count == 10);
+
+  // prefix scans, including an empty prefix and ones ending inside a compressed path
+  const char *prefixes[] = {"", "a", "ab", "abca", "dd", "a_long", "a_long_shared_prefix_", "a_long_shared_prefix_c", "x"};
+  for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+    entry_t prefix;
+    prefix.len = strlen(prefixes[i]);
+    memcpy(prefix.data, prefixes[i], prefix.len);
+    expect_keys(&scan, sorted, N, prefix_filter, &prefix);
+    assert(art_iter_prefix(&tree, prefix.data, prefix.len, scan_callback, &scan) == 0 && scan.pos == scan.n);
+  }
+
+  // range scans between random keys, present or not, and open bounds
+  for (int i = 0; i < 200; i++) {
+    entry_t lo = keys[rand() % N], hi = keys[rand() % N];
+    entry_t *bounds[2] = {&lo, &hi};
+    if (key_compare(&bounds[0], &bounds[1]) > 0) {
+      bounds[0] = &hi;
+      bounds[1] = &lo;
+    }
+    if (i % 2 == 0 && bounds[0]->len > 0) {
+      bounds[0]->len--;
+    }
+    expect_keys(&scan, sorted, N, range_filter, bounds);
+    assert(art_iter_range(&tree, bounds[0]->data, bounds[0]->len, bounds[1]->data, bounds[1]->len, scan_callback,
+                          &scan) == 0);
+    assert(scan.pos == scan.n);
+  }
+  expect_keys(&scan, sorted, N, NULL, NULL);
+  assert(art_iter_range(&tree, NULL, 0, NULL, 0, scan_callback, &scan) == 0 && scan.pos == scan.n);
+
+  // erase two thirds, the nodes shrink and paths get compressed again
+  for (int i = 0; i < N; i++) {
+    entry_t *key = sorted[i];
+    if (i % 3 != 0 && key->present) {
+      assert(art_erase(&tree, key->data, key->len));
+      assert(!art_erase(&tree, key->data, key->len));
+      key->present = false;
+      n_present--;
+    }
+  }
+  assert(art_size(&tree) == n_present);
+  for (int i = 0; i < N; i++) {
+    void *found = NULL;
+    assert(art_find(&tree, sorted[i]->data, sorted[i]->len, &found) == (found != NULL));
+    assert(!sorted[i]->present || found == sorted[i]);
+  }
+  expect_keys(&scan, sorted, N, NULL, NULL);
+  assert(art_iter(&tree, scan_callback, &scan) == 0 && scan.pos == scan.n);
+
+  for (int i = 0; i < N; i++) {
+    if (sorted[i]->present) {
+      assert(art_erase(&tree, sorted[i]->data, sorted[i]->len));
+      sorted[i]->present = false;
+    }
+  }
+  assert(art_size(&tree) == 0 && tree.root == NULL);
+
+  // every first byte grows the root up to a Node256 and back
+  for (int i = 0; i < 256; i++) {
+    byte key[2] = {(byte)i, 'x'};
+    assert(art_insert(&tree, key, 2, &keys[i]));
+  }
+  assert(((art_node_t *)tree.root)->type == ART_NODE256);
+  for (int i = 0; i < 256; i++) {
+    byte key[2] = {(byte)i, 'x'};
+    if (i % 8 != 1) {
+      assert(art_erase(&tree, key, 2));
+    }
+  }
+  assert(((art_node_t *)tree.root)->type == ART_NODE48);
+  for (int i = 0; i < 256; i++) {
+    byte key[2] = {(byte)i, 'x'};
+    assert(art_find(&tree, key, 2, &value) == (i % 8 == 1));
+    assert(i % 8 != 1 || value == &keys[i]);
+  }
+
+  // the whole tree goes at once
+  art_clear(&tree);
+  assert(art_size(&tree) == 0 && !art_find(&tree, (const byte *)"\x01x", 2, NULL));
+  assert(art_insert(&tree, (const byte *)"", 0, &keys[0]));
+  assert(art_insert(&tree, (const byte *)"a", 1, &keys[1]));
+  assert(art_find(&tree, (const byte *)"", 0, &value) && value == &keys[0]);
+  assert(art_erase(&tree, (const byte *)"", 0) && art_find(&tree, (const byte *)"a", 1, NULL));
+
+  // insert and erase churn over a bounded key set reuses the freed leaves and nodes
+  size_t heap_size = 0;
+  art_clear(&tree);
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < N; i++) {
+      entry_t *key = &keys[i];
+      if (key->present) {
+        assert(art_erase(&tree, key->data, key->len));
+        key->present = false;
+      } else if (rand() % 4 == 0) {
+        key->len = rand() % MAX_LEN;
+        for (size_t j = 0; j < key->len; j++) {
+          key->data[j] = (byte)('a' + rand() % 4);
+        }
+        key->present = art_insert(&tree, key->data, key->len, key);
+      }
+    }
+    if (round == 9) {
+      heap_size = mem_heap_get_size(tree.heap);
+    }
+  }
+  printf("churn heap %zu, was %zu\n", mem_heap_get_size(tree.heap), heap_size);
+  assert(mem_heap_get_size(tree.heap) < heap_size + heap_size / 4);
+  art_destroy(&tree);
+
+  printf("art test passed\n");
+  return 0;
+}
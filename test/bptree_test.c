@@ -0,0 +1,124 @@
+#include "bptree.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N 200000
+
+static bool str_less(const void *a, const void *b) {
+  return strcmp((const char *)a, (const char *)b) < 0;
+}
+
+// Checks that a full scan sees exactly the keys of present in order.
+static void check_scan(bpt_t *tree, const bool *present) {
+  bpt_cursor_t cursor;
+  bpt_key_t prev = -1;
+  size_t n = 0;
+
+  for (bpt_begin(tree, &cursor); bpt_cursor_valid(&cursor); bpt_cursor_next(&cursor)) {
+    bpt_key_t key = bpt_cursor_key(&cursor);
+    assert(key > prev && present[key]);
+    assert(bpt_cursor_value(&cursor) == (void *)(intptr_t)(key * 2));
+    prev = key;
+    n++;
+  }
+  assert(n == bpt_size(tree));
+}
+
+int main(int argc, char const *argv[]) {
+  static bool present[N];
+  bpt_t tree;
+  bpt_cursor_t cursor;
+  void *value;
+
+  assert(sizeof(bpt_leaf_t) <= BPT_NODE_SIZE && sizeof(bpt_inner_t) <= BPT_NODE_SIZE);
+
+  // random inserts of integer keys
+  bpt_init(&tree, NULL);
+  srand(3);
+  for (int i = 0; i < N; i++) {
+    bpt_key_t key = rand() % N;
+    assert(bpt_insert(&tree, key, (void *)(intptr_t)(key * 2)) == !present[key]);
+    present[key] = true;
+  }
+  check_scan(&tree, present);
+  printf("%zu keys, height %zu\n", bpt_size(&tree), tree.height);
+
+  // node chunks fill the heap blocks
+  mem_pool_stat_t stat;
+  mem_pool_get_stat(tree.pool, &stat);
+  printf("%zu nodes, heap %zu\n", stat.n_total, stat.heap_size);
+  assert(stat.heap_size < stat.n_total * BPT_NODE_SIZE / 20 * 21 + 16384);
+
+  for (bpt_key_t key = 0; key < N; key++) {
+    assert(bpt_find(&tree, key, &value) == present[key]);
+    assert(!present[key] || value == (void *)(intptr_t)(key * 2));
+  }
+
+  // range scan from a missing key
+  for (bpt_key_t key = 0; key < N; key += 997) {
+    bpt_key_t expect = key;
+    while (expect < N && !present[expect]) {
+      expect++;
+    }
+    bpt_lower_bound(&tree, key, &cursor);
+    assert(expect == N ? !bpt_cursor_valid(&cursor) : bpt_cursor_key(&cursor) == expect);
+  }
+
+  // lazy erase, leaves may become empty and are skipped
+  for (bpt_key_t key = 0; key < N; key++) {
+    if (key % 3 != 0 || key > N / 2) {
+      assert(bpt_erase(&tree, key) == present[key]);
+      present[key] = false;
+    }
+  }
+  check_scan(&tree, present);
+  bpt_lower_bound(&tree, N / 2 + 1, &cursor);
+  assert(!bpt_cursor_valid(&cursor));
+  for (bpt_key_t key = N / 2; key < N; key++) {
+    assert(bpt_insert(&tree, key, (void *)(intptr_t)(key * 2)));
+    present[key] = true;
+  }
+  check_scan(&tree, present);
+  bpt_destroy(&tree);
+
+  // bulk load from a sorted vector
+  vector_t entries;
+  vector_init(&entries, sizeof(bpt_entry_t));
+  for (bpt_key_t key = 0; key < N; key++) {
+    present[key] = key % 2 == 0;
+    if (present[key]) {
+      bpt_entry_t entry = {key, (void *)(intptr_t)(key * 2)};
+      vector_push_back(&entries, &entry);
+    }
+  }
+  bpt_init(&tree, NULL);
+  bpt_bulk_load(&tree, &entries);
+  check_scan(&tree, present);
+  for (bpt_key_t key = 1; key < N; key += 2) {
+    assert(!bpt_find(&tree, key, NULL));
+    assert(bpt_insert(&tree, key, (void *)(intptr_t)(key * 2)));
+    present[key] = true;
+  }
+  check_scan(&tree, present);
+  bpt_destroy(&tree);
+  vector_destroy(&entries);
+
+  // keys compared through a Compare
+  static char names[1000][8];
+  bpt_init(&tree, str_less);
+  for (int i = 0; i < 1000; i++) {
+    sprintf(names[i], "k%04d", 999 - i);
+    assert(bpt_insert(&tree, (bpt_key_t)(intptr_t)names[i], names[i]));
+  }
+  assert(!bpt_insert(&tree, (bpt_key_t)(intptr_t) "k0500", NULL));
+  assert(bpt_find(&tree, (bpt_key_t)(intptr_t) "k0500", &value) && strcmp(value, "k0500") == 0);
+  bpt_lower_bound(&tree, (bpt_key_t)(intptr_t) "k0998x", &cursor);
+  assert(strcmp(bpt_cursor_value(&cursor), "k0999") == 0);
+  bpt_cursor_next(&cursor);
+  assert(!bpt_cursor_valid(&cursor));
+  bpt_destroy(&tree);
+
+  return 0;
+}
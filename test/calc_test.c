@@ -0,0 +1,40 @@
+#include "calc.h"
+#include <assert.h>
+#include <string.h>
+
+int main(int argc, char const *argv[]) {
+  byte data[1024];
+  calc_hash_state_t state;
+
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (byte)(i * 131 + 7);
+  }
+
+  // any split of the input hashes like the whole
+  for (size_t len = 0; len <= 300; len++) {
+    uint64_t h = calc_hash_binary(data, len, 42);
+    for (size_t chunk = 1; chunk <= 64; chunk++) {
+      calc_hash_init(&state, 42);
+      for (size_t off = 0; off < len; off += chunk) {
+        calc_hash_update(&state, data + off, min(chunk, len - off));
+      }
+      assert(calc_hash_final(&state) == h);
+    }
+    assert(calc_hash_binary(data, len, 43) != h);
+  }
+
+  assert(calc_fold_string("wheelib") == calc_fold_binary((const byte *)"wheelib", 7));
+  assert(calc_hash_string("wheelib", 1) != calc_hash_string("wheelic", 1));
+  assert(calc_hash_uint64(1, 0) != calc_hash_uint64(2, 0));
+
+  // sequential integers spread over a power of two table
+  size_t buckets[256] = {0};
+  for (uint64_t i = 0; i < 256 * 64; i++) {
+    buckets[calc_fold_uint64(i) & 255]++;
+  }
+  for (size_t i = 0; i < 256; i++) {
+    assert(buckets[i] > 16 && buckets[i] < 128);
+  }
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include "dyn.h"
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char const *argv[]) {
+  dyn_array_t arr;
+  char rec[100];
+  size_t total = 0;
+
+  dyn_array_create(&arr);
+
+  for (int i = 0; i < 10000; ++i) {
+    int len = 1 + i % 97;
+    memset(rec, 'a' + i % 26, len);
+    memcpy(dyn_array_push(&arr, len), rec, len);
+    total += len;
+  }
+
+  assert(dyn_array_get_data_size(&arr) == total);
+
+  dyn_array_cursor_t cur;
+  const byte *data;
+  size_t len, pos = 0;
+
+  dyn_array_cursor_init(&cur, &arr, 0);
+  while ((len = dyn_array_cursor_next(&cur, &data)) > 0) {
+    for (size_t i = 0; i < len; ++i)
+      assert(*(byte *)dyn_array_get_element(&arr, pos + i) == data[i]);
+    pos += len;
+  }
+  assert(pos == total);
+
+  byte buf[1000];
+  dyn_array_cursor_init(&cur, &arr, total - 1000);
+  assert(dyn_array_cursor_read(&cur, buf, sizeof(buf)) == 1000);
+  assert(memcmp(buf + 999, dyn_array_get_element(&arr, total - 1), 1) == 0);
+  assert(dyn_array_cursor_read(&cur, buf, sizeof(buf)) == 0);
+
+  printf("%zu bytes in %zu blocks\n", total, LIST_GET_LEN(arr.base));
+
+  dyn_array_free(&arr);
+
+  static char big[100000];
+  dyn_array_create_sized(&arr, 4096, 1 << 20);
+  for (size_t i = 0; i < sizeof(big); ++i)
+    big[i] = 'a' + i % 26;
+
+  memcpy(dyn_array_push(&arr, 100), big, 100);
+  memcpy(dyn_array_push(&arr, 20000), big + 100, 20000);
+  dyn_push_string(&arr, big + 20100, sizeof(big) - 20100);
+  assert(dyn_array_get_data_size(&arr) == sizeof(big));
+
+  dyn_array_cursor_init(&cur, &arr, 0);
+  static char copy[sizeof(big)];
+  assert(dyn_array_cursor_read(&cur, copy, sizeof(copy)) == sizeof(big));
+  assert(memcmp(copy, big, sizeof(big)) == 0);
+  printf("%zu bytes in %zu blocks\n", sizeof(big), LIST_GET_LEN(arr.base));
+
+  FILE *tmp = tmpfile();
+  int fd = fileno(tmp);
+  assert(dyn_array_write(&arr, fd) == sizeof(big));
+  assert(dyn_array_pwrite(&arr, fd, 10) == sizeof(big));
+  assert(pread(fd, copy, sizeof(copy), 10) == sizeof(big));
+  assert(memcmp(copy, big, sizeof(big)) == 0);
+  fclose(tmp);
+
+  // a full nonblocking pipe stops the write, the bytes already sent are reported
+  int fds[2];
+  assert(pipe(fds) == 0);
+  fcntl(fds[1], F_SETFL, O_NONBLOCK);
+  ssize_t written = dyn_array_write(&arr, fds[1]);
+  assert(written > 0 && written < (ssize_t)sizeof(big));
+  assert(dyn_array_write(&arr, fds[1]) == -1 && errno == EAGAIN);
+  assert(read(fds[0], copy, written) == written && memcmp(copy, big, written) == 0);
+  close(fds[0]);
+  close(fds[1]);
+
+  struct iovec iov[8];
+  assert(dyn_array_get_iovec(&arr, iov, 8) == LIST_GET_LEN(arr.base));
+  assert(iov[0].iov_len == 100 && memcmp(iov[0].iov_base, big, 100) == 0);
+
+  dyn_array_free(&arr);
+  return 0;
+}
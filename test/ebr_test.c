@@ -0,0 +1,123 @@
+#include "ebr.h"
+#include "hash.h"
+#include "mutex.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define N_KEYS 1024
+#define N_READERS 4
+#define N_ROUNDS 50000
+
+struct item {
+  size_t key;
+  size_t alive;
+  hash_node_t hash;
+};
+
+static hash_table_t *tbl;
+static mutex_t writer_mutex;
+static size_t n_freed;
+static int done;
+
+static void item_free(void *ptr) {
+  struct item *it = (struct item *)ptr;
+  it->alive = 0;
+  free(it);
+  __atomic_fetch_add(&n_freed, 1, __ATOMIC_RELAXED);
+}
+
+static void *reader(void *arg) {
+  size_t n_lookups = 0;
+  size_t n_found = 0;
+  struct item *s;
+
+  while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+    for (size_t key = 0; key < N_KEYS; key++) {
+      ebr_enter();
+      HASH_SEARCH_LF(hash, tbl, calc_fold_uint64(key), struct item *, s, assert(s->alive == 1), s->key == key);
+      if (s != NULL) {
+        n_found++;
+      }
+      ebr_exit();
+      n_lookups++;
+    }
+  }
+  assert(n_found > 0);
+  return (void *)n_lookups;
+}
+
+// Replaces a node at a time with a new copy and retires the old one.
+static void *writer(void *arg) {
+  unsigned seed = 1;
+  struct item *s;
+
+  for (size_t i = 0; i < N_ROUNDS; i++) {
+    size_t key = rand_r(&seed) % N_KEYS;
+    struct item *it = malloc(sizeof(struct item));
+    it->key = key;
+    it->alive = 1;
+
+    mutex_lock(&writer_mutex);
+    HASH_SEARCH_LF(hash, tbl, calc_fold_uint64(key), struct item *, s, , s->key == key);
+    assert(s != NULL);
+    HASH_DELETE_LF(struct item, hash, tbl, calc_fold_uint64(key), s);
+    HASH_INSERT_LF(struct item, hash, tbl, calc_fold_uint64(key), it);
+    mutex_unlock(&writer_mutex);
+
+    ebr_retire(s, item_free);
+  }
+  ebr_synchronize();
+  assert(ebr_get_n_pending() == 0);
+  return NULL;
+}
+
+int main(int argc, char const *argv[]) {
+  pthread_t readers[N_READERS];
+  pthread_t writer_thread;
+  size_t n_lookups = 0;
+  void *ret;
+
+  // nested critical sections and synchronize in a single thread
+  ebr_enter();
+  ebr_enter();
+  assert(ebr_in_critical());
+  ebr_exit();
+  ebr_exit();
+  assert(!ebr_in_critical());
+
+  tbl = hash_create(N_KEYS);
+  mutex_init(&writer_mutex);
+  for (size_t key = 0; key < N_KEYS; key++) {
+    struct item *it = malloc(sizeof(struct item));
+    it->key = key;
+    it->alive = 1;
+    HASH_INSERT_LF(struct item, hash, tbl, calc_fold_uint64(key), it);
+  }
+
+  for (size_t i = 0; i < N_READERS; i++) {
+    pthread_create(&readers[i], NULL, reader, NULL);
+  }
+  pthread_create(&writer_thread, NULL, writer, NULL);
+  pthread_join(writer_thread, NULL);
+  __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+  for (size_t i = 0; i < N_READERS; i++) {
+    pthread_join(readers[i], &ret);
+    n_lookups += (size_t)ret;
+  }
+
+  assert(n_freed == N_ROUNDS);
+  assert(tbl->n_nodes == N_KEYS);
+  printf("epoch %zu freed %zu lookups %zu\n", ebr_get_epoch(), n_freed, n_lookups);
+
+  for (size_t key = 0; key < N_KEYS; key++) {
+    struct item *s;
+    HASH_SEARCH_LF(hash, tbl, calc_fold_uint64(key), struct item *, s, , s->key == key);
+    assert(s != NULL);
+    HASH_DELETE_LF(struct item, hash, tbl, calc_fold_uint64(key), s);
+    free(s);
+  }
+  hash_table_free(tbl);
+  mutex_destroy(&writer_mutex);
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "hash_part.h"
+#include <pthread.h>
+#include <stdio.h>
+
+#define N_THREADS 4
+#define N_PER_THREAD 20000
+
+struct item {
+  size_t key;
+  hash_node_t hash;
+};
+
+static hash_part_table_t *tbl;
+static struct item items[N_THREADS][N_PER_THREAD];
+
+static size_t item_fold(const void *node) {
+  return calc_fold_uint64(((const struct item *)node)->key);
+}
+
+static void *worker(void *arg) {
+  size_t t = (size_t)arg;
+  struct item *s;
+
+  for (size_t i = 0; i < N_PER_THREAD; i++) {
+    struct item *it = &items[t][i];
+    it->key = t * N_PER_THREAD + i;
+    HASH_PART_INSERT(struct item, hash, tbl, calc_fold_uint64(it->key), it);
+  }
+  for (size_t i = 0; i < N_PER_THREAD; i++) {
+    size_t key = t * N_PER_THREAD + i;
+    HASH_PART_SEARCH(hash, tbl, calc_fold_uint64(key), struct item *, s, , s->key == key);
+    assert(s == &items[t][i]);
+  }
+  for (size_t i = 0; i < N_PER_THREAD; i += 2) {
+    HASH_PART_DELETE(struct item, hash, tbl, calc_fold_uint64(items[t][i].key), &items[t][i]);
+  }
+  return NULL;
+}
+
+int main(int argc, char const *argv[]) {
+  pthread_t threads[N_THREADS];
+  hash_part_stat_t stat;
+  struct item *s;
+
+  tbl = hash_part_create_resizable(64, 6, item_fold, offsetof(struct item, hash));
+  assert(tbl->n_parts == 8);
+
+  for (size_t t = 0; t < N_THREADS; t++) {
+    pthread_create(&threads[t], NULL, worker, (void *)t);
+  }
+  for (size_t t = 0; t < N_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  for (size_t key = 0; key < N_THREADS * N_PER_THREAD; key++) {
+    HASH_PART_SEARCH(hash, tbl, calc_fold_uint64(key), struct item *, s, , s->key == key);
+    assert((s != NULL) == (key % 2 == 1));
+  }
+
+  hash_part_get_stat(tbl, tbl->n_parts, &stat);
+  assert(stat.n_nodes == N_THREADS * N_PER_THREAD / 2);
+  assert(stat.n_writes == N_THREADS * N_PER_THREAD * 3 / 2);
+  assert(stat.n_reads == N_THREADS * N_PER_THREAD * 2);
+  printf("nodes %zu reads %zu writes %zu read waits %zu write waits %zu\n", stat.n_nodes, stat.n_reads,
+         stat.n_writes, stat.n_read_waits, stat.n_write_waits);
+
+  for (size_t i = 0; i < tbl->n_parts; i++) {
+    hash_part_get_stat(tbl, i, &stat);
+    assert(stat.n_nodes > 0);
+  }
+
+  hash_part_free(tbl);
+  return 0;
+}
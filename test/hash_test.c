@@ -9,6 +9,85 @@ struct student {
   hash_node_t hash;
 };
 
+static size_t student_fold(const void *node) {
+  return calc_fold_string(((const struct student *)node)->name);
+}
+
+static bool student_match(const void *node, const void *key) {
+  return strcmp(((const struct student *)node)->name, (const char *)key) == 0;
+}
+
+// A resizable table grows while it is filled.
+static void test_resizable(size_t type) {
+  hash_table_t *tbl = HASH_CREATE_RESIZABLE(struct student, hash, 10, type, student_fold);
+  struct student *s;
+  struct student *stus = malloc(sizeof(struct student) * 10000);
+  for (int i = 0; i < 10000; ++i) {
+    stus[i].id = i;
+    sprintf(stus[i].name, "n%d", i);
+    HASH_INSERT(struct student, hash, tbl, calc_fold_string(stus[i].name), &stus[i]);
+
+    HASH_SEARCH(hash, tbl, calc_fold_string(stus[i / 2].name), struct student *, s, , s->id == i / 2);
+    assert(s == &stus[i / 2]);
+
+    // the chain of a node not moved yet is still found by its fold
+    if (tbl->old_array != NULL) {
+      for (s = HASH_GET_FIRST_FOLD(tbl, calc_fold_string(stus[0].name)); s != &stus[0]; s = HASH_GET_NEXT(hash, s)) {
+        assert(s != NULL);
+      }
+    }
+  }
+  assert(tbl->n_nodes == 10000);
+  assert(hash_get_n_cells(tbl) >= 5000);
+
+  for (int i = 0; i < 10000; i += 2) {
+    HASH_DELETE(struct student, hash, tbl, calc_fold_string(stus[i].name), &stus[i]);
+  }
+  for (int i = 0; i < 10000; ++i) {
+    HASH_SEARCH(hash, tbl, calc_fold_string(stus[i].name), struct student *, s, , s->id == i);
+    assert((s != NULL) == (i % 2 == 1));
+  }
+  // batch lookup, with keys that were deleted
+  size_t *folds = malloc(sizeof(size_t) * 10000);
+  const void **keys = malloc(sizeof(void *) * 10000);
+  struct student **found = malloc(sizeof(struct student *) * 10000);
+  for (int i = 0; i < 10000; ++i) {
+    folds[i] = calc_fold_string(stus[9999 - i].name);
+    keys[i] = stus[9999 - i].name;
+  }
+  assert(HASH_SEARCH_BATCH(struct student, hash, tbl, 10000, folds, keys, student_match, found) == 5000);
+  for (int i = 0; i < 10000; ++i) {
+    assert(found[i] == ((9999 - i) % 2 == 1 ? &stus[9999 - i] : NULL));
+  }
+  assert(HASH_SEARCH_BATCH(struct student, hash, tbl, 7, folds, keys, student_match, found) == 4);
+  free(folds);
+  free(keys);
+  free(found);
+
+  hash_table_stat_t stat;
+  size_t n_cells = 0;
+  HASH_TABLE_GET_STAT(struct student, hash, tbl, &stat);
+  for (int i = 0; i < HASH_STAT_HIST_SIZE; ++i) {
+    n_cells += stat.hist[i];
+  }
+  assert(stat.n_nodes == 5000);
+  assert(stat.n_filled <= stat.n_nodes && stat.max_chain >= 1);
+  // 20000 searches, sampled at random
+  assert(stat.n_sampled > 20000 / HASH_PROBE_SAMPLE * 2 / 3 && stat.n_sampled < 20000 / HASH_PROBE_SAMPLE * 3 / 2);
+  assert(stat.n_searches == stat.n_sampled * HASH_PROBE_SAMPLE);
+  assert(stat.avg_probes >= 0.5 && stat.avg_probes < 4);
+  assert(n_cells >= stat.n_cells);
+  hash_table_print_stat(tbl, offsetof(struct student, hash), stdout);
+
+  HASH_SEARCH_ALL(hash, tbl, struct student *, s, , s->id == 9999);
+  assert(s == &stus[9999]);
+  assert(tbl->n_nodes == 5000);
+  printf("resized to %zu cells\n", hash_get_n_cells(tbl));
+
+  hash_table_free(tbl);
+  free(stus);
+}
+
 int main(int argc, char const *argv[]) {
   hash_table_t *tbl = hash_create(10);
 
@@ -26,5 +105,31 @@ int main(int argc, char const *argv[]) {
   }
 
   hash_table_free(tbl);
+
+  test_resizable(HASH_TABLE_PRIME);
+  test_resizable(HASH_TABLE_POW2);
+
+  // searches alternating between two tables are sampled on both
+  hash_table_t *tables[2] = {hash_create(10), hash_create(10)};
+  for (int i = 0; i < 20000; ++i) {
+    HASH_SEARCH(hash, tables[i % 2], i, struct student *, s, , true);
+  }
+  for (int i = 0; i < 2; ++i) {
+    hash_table_stat_t stat;
+    HASH_TABLE_GET_STAT(struct student, hash, tables[i], &stat);
+    assert(stat.n_sampled > 10000 / HASH_PROBE_SAMPLE / 2 && stat.n_sampled < 10000 / HASH_PROBE_SAMPLE * 2);
+    hash_table_free(tables[i]);
+  }
+
+  // reciprocal reduction matches a divide
+  for (size_t n = 1; n < 100000; n = n * 3 + 1) {
+    hash_table_t *t = hash_create(n);
+    for (uint64_t f = 0; f < 10000; f++) {
+      uint64_t fold = calc_hash_uint64(f, n) ^ (f << 60);
+      uint64_t h = fold ^ HASH_RANDOM_MASK2;
+      assert(hash_calc_hash(fold, t) == (uint32_t)(h ^ (h >> 32)) % t->n_cells);
+    }
+    hash_table_free(t);
+  }
   return 0;
 }
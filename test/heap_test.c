@@ -1,17 +1,135 @@
 #include "heap.h"
+#include <assert.h>
+#include <pthread.h>
 #include <string.h>
 #include <stdio.h>
 
+static int churn_done;
+
+// Grows and drops blocks of a registered heap while another thread dumps the registry.
+static void *churn(void *arg)
+{
+    mem_heap_t *heap = arg;
+
+    while (!__atomic_load_n(&churn_done, __ATOMIC_ACQUIRE)) {
+        for (int i = 0; i < 100; ++i) {
+            mem_heap_alloc(heap, 1000);
+        }
+        mem_heap_empty(heap);
+    }
+    return NULL;
+}
+
 int main(int argc, char const *argv[])
 {
     mem_heap_t *heap = mem_heap_create(1024);
 
     char *str = mem_heap_alloc(heap, 64);
-    memset(str, 'a', 64);
+    memset(str, 'a', 63);
+    str[63] = '\0';
 
     printf("%s\n", str);
 
     mem_heap_free(heap);
 
+    mem_heap_cache_stat_t stat;
+    mem_heap_cache_set_max(64);
+
+    for (int i = 0; i < 100; ++i) {
+        heap = mem_heap_create(0);
+        for (int j = 0; j < 100; ++j) {
+            memset(mem_heap_alloc(heap, 100), j, 100);
+        }
+        mem_heap_free(heap);
+    }
+
+    mem_heap_cache_get_stat(&stat);
+    printf("cache hits: %zu, misses: %zu, cached: %zu/%zu\n",
+           stat.hits, stat.misses, stat.n_cached, stat.max_cached);
+    assert(stat.hits > 0);
+    assert(stat.n_cached <= stat.max_cached);
+
+    mem_heap_cache_trim();
+    mem_heap_cache_get_stat(&stat);
+    assert(stat.n_cached == 0);
+
+    mem_heap_registry_enable(true);
+    heap = mem_heap_create(0);
+    mem_heap_t *heap2 = mem_heap_create_func(0, MEM_HEAP_DYNAMIC, "named");
+    for (int i = 1; i < 300; ++i) {
+        mem_heap_alloc(heap, i);
+    }
+    mem_heap_stat_t hstat;
+    mem_heap_get_stat(heap, &hstat);
+#ifdef MEM_HEAP_STATS
+    assert(hstat.n_allocs == 299);
+    assert(hstat.requested == 299 * 300 / 2);
+    assert(hstat.used == hstat.requested + hstat.round_waste);
+#else
+    assert(hstat.n_allocs == 0 && hstat.requested == 0 && hstat.used > 0);
+#endif
+    assert(hstat.n_blocks > 1 && hstat.peak_size >= hstat.total_size);
+    mem_heap_registry_print(stdout);
+    assert(mem_heap_get_n_heaps() == 2);
+    mem_heap_free(heap2);
+    mem_heap_free(heap);
+
+    pthread_t thread;
+    FILE *null = fopen("/dev/null", "w");
+    heap = mem_heap_create(0);
+    pthread_create(&thread, NULL, churn, heap);
+    for (int i = 0; i < 1000; ++i) {
+        mem_heap_registry_print(null);
+    }
+    __atomic_store_n(&churn_done, 1, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    fclose(null);
+    mem_heap_free(heap);
+    mem_heap_registry_enable(false);
+    assert(mem_heap_get_n_heaps() == 0);
+
+    heap = mem_heap_create(0);
+    for (int i = 0; i < 200; ++i) {
+        mem_heap_alloc(heap, 3);
+        byte *line = mem_heap_alloc_aligned(heap, 100, 64);
+        assert(((uintptr_t)line & 63) == 0);
+        memset(line, i, 100);
+    }
+    assert(((uintptr_t)mem_heap_alloc_aligned(heap, 10000, 4096) & 4095) == 0);
+    mem_heap_free(heap);
+
+    heap = mem_heap_create(0);
+    char *rec = mem_heap_alloc(heap, 8);
+    memcpy(rec, "1234567", 8);
+    rec = mem_heap_realloc_top(heap, rec, 8, 32);
+    assert(strcmp(rec, "1234567") == 0);
+    rec = mem_heap_realloc_top(heap, rec, 32, 20000);
+    assert(strcmp(rec, "1234567") == 0);
+    mem_str_t sb;
+    mem_str_init(&sb, heap);
+    for (int i = 0; i < 1000; ++i) {
+        mem_str_printf(&sb, "%d,", i);
+    }
+    mem_str_append(&sb, "end", 3);
+    char *out = mem_str_finish(&sb);
+    assert(strncmp(out, "0,1,2,", 6) == 0);
+    assert(strlen(out) == sb.len);
+    assert(strcmp(out + sb.len - 11, "998,999,end") == 0);
+    assert(strcmp(mem_heap_printf(heap, "%s-%d", "x", 42), "x-42") == 0);
+    assert(strcmp(mem_heap_strdup(heap, "dup"), "dup") == 0);
+    mem_heap_free(heap);
+
+    heap = mem_heap_create_typed(0, MEM_HEAP_HUGE);
+    byte *top = mem_heap_get_heap_top(heap);
+    for (int i = 0; i < 1000; ++i) {
+        memset(mem_heap_alloc(heap, 8192), i, 8192);
+    }
+    printf("huge heap size: %zu\n", mem_heap_get_size(heap));
+    assert(mem_heap_get_size(heap) >= 1000 * 8192);
+    mem_heap_free_heap_top(heap, top);
+    assert(mem_heap_get_heap_top(heap) == top);
+    mem_heap_empty(heap);
+    mem_heap_free(heap);
+
     return 0;
 }
@@ -0,0 +1,43 @@
+#include "hmap.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define N 200000
+
+int main(int argc, char const *argv[]) {
+  hmap_t *map = hmap_create(sizeof(uint64_t), sizeof(uint64_t), NULL, NULL, 0);
+  bool inserted;
+
+  for (uint64_t i = 0; i < N; ++i) {
+    uint64_t value = i * 3;
+    hmap_insert(map, &i, &value, &inserted);
+    assert(inserted);
+  }
+  assert(hmap_size(map) == N);
+
+  for (uint64_t i = 0; i < N; ++i) {
+    uint64_t *value = hmap_find(map, &i);
+    assert(value && *value == i * 3);
+  }
+
+  for (uint64_t i = 0; i < N; i += 2)
+    assert(hmap_erase(map, &i));
+
+  for (uint64_t i = 0; i < N; ++i) {
+    uint64_t *value = hmap_find(map, &i);
+    assert((i % 2) ? (value && *value == i * 3) : value == NULL);
+  }
+
+  size_t pos = 0, count = 0;
+  void *key, *value;
+  while (hmap_next(map, &pos, &key, &value)) {
+    assert(*(uint64_t *)key % 2 == 1);
+    count++;
+  }
+  assert(count == N / 2 && hmap_size(map) == N / 2);
+
+  printf("%zu entries, capacity %zu\n", hmap_size(map), map->capacity);
+  hmap_free(map);
+  return 0;
+}
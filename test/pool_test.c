@@ -0,0 +1,64 @@
+#include "pool.h"
+#include <assert.h>
+#include <stdio.h>
+
+struct node {
+  int id;
+  struct node *next;
+};
+
+int main(int argc, char const *argv[]) {
+  mem_pool_t *pool = MEM_POOL_CREATE(struct node, 0);
+  struct node *head = NULL;
+
+  for (int i = 0; i < 1000; ++i) {
+    struct node *n = MEM_POOL_ALLOC(struct node, pool);
+    n->id = i;
+    n->next = head;
+    head = n;
+  }
+
+  for (int i = 0; i < 500; ++i) {
+    struct node *n = head;
+    head = head->next;
+    mem_pool_release(pool, n);
+  }
+
+  struct node *reused = MEM_POOL_ALLOC(struct node, pool);
+
+  mem_pool_stat_t stat;
+  mem_pool_get_stat(pool, &stat);
+  printf("slot %zu, used %zu, free %zu, total %zu, peak %zu, heap %zu\n",
+         stat.slot_size, stat.n_used, stat.n_free, stat.n_total,
+         stat.peak_used, stat.heap_size);
+  assert(stat.n_used == 501 && stat.n_free == 499 && stat.n_total == 1000);
+
+  mem_pool_empty(pool);
+  mem_pool_get_stat(pool, &stat);
+  assert(stat.n_used == 0 && stat.n_total == 0);
+  reused = MEM_POOL_ALLOC(struct node, pool);
+  reused->id = 1;
+
+  mem_pool_free(pool);
+
+  // slots on cache line boundaries
+  pool = mem_pool_create_aligned(100, 0, 64);
+  for (int i = 0; i < 200; i++) {
+    void *ptr = mem_pool_alloc(pool);
+    assert(((uintptr_t)ptr & 63) == 0);
+  }
+  mem_pool_get_stat(pool, &stat);
+  assert(stat.heap_size < stat.n_total * stat.slot_size + 8000);
+  mem_pool_free(pool);
+
+  // the default chunks fill the heap blocks
+  pool = mem_pool_create(16, 0);
+  for (int i = 0; i < 100000; i++) {
+    mem_pool_alloc(pool);
+  }
+  mem_pool_get_stat(pool, &stat);
+  printf("total %zu, heap %zu\n", stat.n_total, stat.heap_size);
+  assert(stat.heap_size < stat.n_total * stat.slot_size / 50 * 51 + 8000);
+  mem_pool_free(pool);
+  return 0;
+}
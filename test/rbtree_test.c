@@ -0,0 +1,147 @@
+#include "rbtree.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 10000
+
+static bool int_less(const void *a, const void *b) {
+    return *(const int *)a < *(const int *)b;
+}
+
+// Returns the black height, checks order, colors and parent links.
+static size_t check(rbt_node_t *node, rbt_node_t *parent, Compare comp) {
+    size_t left, right;
+    if (node == NULL)
+        return 1;
+    assert(node->parent == parent);
+    if (node->color == rbt_red) {
+        assert(node->left == NULL || node->left->color == rbt_black);
+        assert(node->right == NULL || node->right->color == rbt_black);
+    }
+    if (node->left != NULL)
+        assert(!comp(node->value, node->left->value));
+    if (node->right != NULL)
+        assert(!comp(node->right->value, node->value));
+    left = check(node->left, node, comp);
+    right = check(node->right, node, comp);
+    assert(left == right);
+    assert(node->size == 1 + (node->left ? node->left->size : 0) + (node->right ? node->right->size : 0));
+    return left + (node->color == rbt_black);
+}
+
+static void check_tree(rbt_t *tree) {
+    rbt_node_t *root = tree->header->parent;
+    size_t n = 0;
+    rbt_node_t *node;
+    if (root == NULL) {
+        assert(tree->count == 0 && rbt_begin(tree) == rbt_end(tree));
+        return;
+    }
+    assert(root->color == rbt_black);
+    check(root, tree->header, tree->comp);
+    RBT_FOREACH(node, tree) {
+        ++n;
+    }
+    assert(n == tree->count);
+}
+
+struct item {
+    int key;
+    rbt_node_t node;
+};
+
+int main(int argc, char const *argv[]) {
+    static int values[N];
+    rbt_t tree;
+    rbt_node_t *node;
+    bool inserted;
+    int prev;
+
+    srand(7);
+    for (int i = 0; i < N; ++i)
+        values[i] = rand() % (N / 2);
+
+    rbt_init(&tree, int_less);
+    for (int i = 0; i < N; ++i)
+        rbt_insert_unique(&tree, &values[i], &inserted);
+    check_tree(&tree);
+
+    // unique keys in ascending order, and back
+    prev = -1;
+    RBT_FOREACH(node, &tree) {
+        assert(*(int *)node->value > prev);
+        prev = *(int *)node->value;
+    }
+    for (node = rbt_prev(rbt_end(&tree)); node != rbt_begin(&tree); node = rbt_prev(node))
+        assert(*(int *)rbt_prev(node)->value < *(int *)node->value);
+
+    for (int k = -1; k <= N / 2; ++k) {
+        rbt_node_t *lb = rbt_lower_bound(&tree, &k);
+        rbt_node_t *ub = rbt_upper_bound(&tree, &k);
+        assert(lb == rbt_end(&tree) || *(int *)lb->value >= k);
+        assert(ub == rbt_end(&tree) || *(int *)ub->value > k);
+        assert((rbt_find(&tree, &k) != rbt_end(&tree)) == (lb != ub));
+    }
+
+    // select and rank agree with the in-order position
+    size_t k = 0;
+    RBT_FOREACH(node, &tree) {
+        assert(rbt_select(&tree, k) == node);
+        assert(rbt_node_rank(&tree, node) == k);
+        assert(rbt_rank(&tree, node->value) == k);
+        ++k;
+    }
+    assert(rbt_select(&tree, k) == rbt_end(&tree));
+    int big = N;
+    assert(rbt_rank(&tree, &big) == rbt_size(&tree));
+
+    // erase every other value
+    for (int i = 0; i < N; i += 2) {
+        rbt_remove(&tree, &values[i]);
+        if (i % 512 == 0)
+            check_tree(&tree);
+    }
+    check_tree(&tree);
+    for (int i = 0; i < N; i += 2)
+        assert(rbt_find(&tree, &values[i]) == rbt_end(&tree));
+
+    rbt_clear(&tree);
+    check_tree(&tree);
+
+    // equal values are all kept
+    for (int i = 0; i < N; ++i)
+        rbt_insert_equal(&tree, &values[i]);
+    check_tree(&tree);
+    assert(rbt_size(&tree) == N);
+    // the median among duplicates
+    node = rbt_select(&tree, N / 2);
+    assert(rbt_rank(&tree, node->value) <= N / 2 && rbt_rank(&tree, node->value) + rbt_remove(&tree, node->value) > N / 2);
+    check_tree(&tree);
+    for (int i = 0; i < N; ++i) {
+        size_t n = rbt_remove(&tree, &values[i]);
+        assert(n > 0 || rbt_find(&tree, &values[i]) == rbt_end(&tree));
+    }
+    assert(rbt_empty(&tree));
+    rbt_destroy(&tree);
+
+    // nodes embedded in the values
+    struct item *items = malloc(sizeof(struct item) * N);
+    rbt_init_intrusive(&tree, int_less);
+    for (int i = 0; i < N; ++i) {
+        items[i].key = N - i;
+        assert(rbt_insert_node_unique(&tree, &items[i].node, &items[i], &inserted) == &items[i].node);
+        assert(inserted);
+    }
+    check_tree(&tree);
+    assert(((struct item *)rbt_begin(&tree)->value)->key == 1);
+    for (node = rbt_begin(&tree); node != rbt_end(&tree);)
+        node = ((struct item *)node->value)->key % 3 ? rbt_erase(&tree, node) : rbt_next(node);
+    check_tree(&tree);
+    assert(rbt_size(&tree) == N / 3);
+    printf("%zu items left\n", rbt_size(&tree));
+    rbt_destroy(&tree);
+    free(items);
+
+    return 0;
+}
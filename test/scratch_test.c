@@ -0,0 +1,53 @@
+#include "scratch.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static size_t inner(size_t n) {
+  byte *mark = scratch_begin();
+  char *buf = scratch_alloc(n);
+  memset(buf, 'x', n);
+  scratch_end(mark);
+  return n;
+}
+
+int main(int argc, char const *argv[]) {
+  for (int round = 0; round < 3; ++round) {
+    byte *mark = scratch_begin();
+    for (int i = 0; i < 100; ++i) {
+      memset(scratch_alloc(1000), i, 1000);
+      inner(5000);
+    }
+    printf("round %d: %zu blocks, %zu bytes\n", round,
+           LIST_GET_LEN(scratch_get_heap()->base), mem_heap_get_size(scratch_get_heap()));
+    scratch_end(mark);
+  }
+
+  byte *mark = scratch_begin();
+  mem_heap_t *heap = scratch_get_heap();
+  for (int i = 0; i < 100; ++i) {
+    scratch_alloc(1000);
+    inner(5000);
+  }
+  assert(LIST_GET_LEN(heap->base) == 1);
+  assert(scratch_get_heap() == heap);
+  scratch_end(mark);
+
+  // a large inner scope grows the heap once, later rounds run in one block
+  for (int round = 0; round < 5; ++round) {
+    mark = scratch_begin();
+    memset(scratch_alloc(100), 'y', 100);
+    inner(1 << 20);
+    if (round == 0) {
+      assert(LIST_GET_LEN(scratch_get_heap()->base) > 1);
+    } else if (round == 1) {
+      heap = scratch_get_heap();
+      assert(LIST_GET_LEN(heap->base) == 1);
+    } else {
+      assert(scratch_get_heap() == heap && LIST_GET_LEN(heap->base) == 1);
+    }
+    scratch_end(mark);
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "skiplist.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N_THREADS 4
+#define N_KEYS 20000
+
+static skl_t list;
+static pthread_barrier_t barrier;
+static size_t keys[N_KEYS];
+
+static bool size_less(const void *a, const void *b) {
+  return *(const size_t *)a < *(const size_t *)b;
+}
+
+// Each thread inserts its share, then all threads fight over removing and reinserting everything.
+static void *worker(void *arg) {
+  size_t t = (size_t)arg;
+  size_t n_removed = 0;
+
+  for (size_t i = t; i < N_KEYS; i += N_THREADS) {
+    assert(skl_insert(&list, &keys[i]));
+  }
+  pthread_barrier_wait(&barrier);
+  for (size_t round = 0; round < 3; round++) {
+    for (size_t i = 0; i < N_KEYS; i++) {
+      size_t k = (i * 7 + t * 13 + round) % N_KEYS;
+      if (k % 2 == 0) {
+        n_removed += skl_remove(&list, &keys[k]);
+        skl_insert(&list, &keys[k]);
+      } else {
+        assert(skl_find(&list, &keys[k]) == &keys[k]);
+      }
+    }
+  }
+  return (void *)n_removed;
+}
+
+int main(int argc, char const *argv[]) {
+  pthread_t threads[N_THREADS];
+  skl_node_t *node;
+  size_t n = 0;
+  size_t prev = 0;
+
+  for (size_t i = 0; i < N_KEYS; i++) {
+    keys[i] = i;
+  }
+
+  skl_init(&list, size_less);
+  pthread_barrier_init(&barrier, NULL, N_THREADS);
+  for (size_t t = 0; t < N_THREADS; t++) {
+    pthread_create(&threads[t], NULL, worker, (void *)t);
+  }
+  for (size_t t = 0; t < N_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  // every key is back, in order
+  assert(skl_size(&list) == N_KEYS);
+  ebr_enter();
+  SKL_FOREACH(node, &list) {
+    assert(n == 0 || *(size_t *)node->value > prev);
+    prev = *(size_t *)node->value;
+    n++;
+  }
+  assert(n == N_KEYS);
+
+  size_t from = 1000;
+  node = skl_lower_bound(&list, &from);
+  for (size_t i = 1000; i < 1010; i++, node = skl_next(node)) {
+    assert(*(size_t *)node->value == i);
+  }
+  ebr_exit();
+
+  assert(!skl_insert(&list, &keys[5]));
+  for (size_t i = 0; i < N_KEYS; i += 3) {
+    assert(skl_remove(&list, &keys[i]));
+    assert(!skl_remove(&list, &keys[i]));
+    assert(skl_find(&list, &keys[i]) == NULL);
+  }
+  assert(skl_size(&list) == N_KEYS - (N_KEYS + 2) / 3);
+  printf("%zu values left\n", skl_size(&list));
+
+  skl_destroy(&list);
+  pthread_barrier_destroy(&barrier);
+  return 0;
+}
@@ -0,0 +1,169 @@
+#include "wheel.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 20000
+#define N_ROUNDS 4000
+#define N_THREADS 4
+#define N_PER_THREAD 20000
+
+#define START 1000
+
+struct conn {
+  usec_t expire;
+  size_t round;
+  bool scheduled;
+  wheel_timer_t timer;
+};
+
+#define CONN(TIMER) ((struct conn *)((char *)(TIMER) - offsetof(struct conn, timer)))
+
+static struct conn conns[N];
+static wheel_timer_t timers[N_THREADS][N_PER_THREAD];
+static wheel_t wheel;
+static size_t n_fired;
+static int done;
+
+// Spreads timeouts over every level, a few go past the span of the wheel.
+static usec_t random_timeout(void) {
+  switch (rand() % 5) {
+  case 0:
+    return rand() % 100;
+  case 1:
+    return rand() % 5000;
+  case 2:
+    return rand() % 300000;
+  case 3:
+    return (usec_t)rand() * (rand() % 64);
+  default:
+    return rand() % 1000 == 0 ? (usec_t)1 << 37 : (usec_t)(rand() % 50);
+  }
+}
+
+static void schedule(struct conn *conn, usec_t now, size_t round) {
+  // some timers are already due when scheduled
+  conn->expire = now + random_timeout() - (rand() % 10 == 0 ? rand() % 100 : 0);
+  conn->round = round;
+  conn->scheduled = true;
+  wheel_schedule(&wheel, &conn->timer, conn->expire);
+}
+
+static void *driver(void *arg) {
+  wheel_list_t expired;
+  wheel_timer_t *timer;
+
+  LIST_INIT(expired);
+  while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+    wheel_advance(&wheel, usec_now(), &expired);
+    while ((timer = LIST_GET_FIRST(expired)) != NULL) {
+      LIST_REMOVE(link, expired, timer);
+      __atomic_fetch_add(&n_fired, 1, __ATOMIC_RELAXED);
+    }
+  }
+  return NULL;
+}
+
+static void *worker(void *arg) {
+  wheel_timer_t *timers = arg;
+  size_t n_cancelled = 0;
+
+  for (int i = 0; i < N_PER_THREAD; i++) {
+    wheel_timer_init(&timers[i]);
+    wheel_schedule_after(&wheel, &timers[i], (usec_t)(i % 50) * 100);
+    if (i % 2 == 0 && wheel_cancel(&wheel, &timers[i])) {
+      n_cancelled++;
+    }
+  }
+  return (void *)n_cancelled;
+}
+
+int main(int argc, char const *argv[]) {
+  wheel_list_t expired;
+  wheel_timer_t *timer;
+  usec_t now = START, prev, next;
+  size_t n_scheduled = 0, n_cancelled = 0, n_expired = 0;
+  pthread_t threads[N_THREADS + 1];
+
+  // simulated time with 1 microsecond ticks
+  wheel_init(&wheel, 1, START);
+  LIST_INIT(expired);
+  srand(11);
+  for (int i = 0; i < N; i++) {
+    wheel_timer_init(&conns[i].timer);
+  }
+
+  for (size_t round = 1; round <= N_ROUNDS; round++) {
+    for (int i = 0; i < 20; i++) {
+      struct conn *conn = &conns[rand() % N];
+      if (!conn->scheduled) {
+        schedule(conn, now, round);
+        n_scheduled++;
+      } else if (rand() % 3 == 0) {
+        assert(wheel_cancel(&wheel, &conn->timer));
+        assert(!wheel_cancel(&wheel, &conn->timer));
+        conn->scheduled = false;
+        n_cancelled++;
+      } else {
+        schedule(conn, now, round);
+      }
+    }
+    assert(wheel_size(&wheel) == n_scheduled - n_cancelled - n_expired);
+
+    // the driving thread may sleep until the reported time
+    if (round % 50 == 0 && wheel_next_expire(&wheel, &next)) {
+      for (int i = 0; i < N; i++) {
+        assert(!conns[i].scheduled || conns[i].expire >= next || conns[i].round == round);
+      }
+    }
+
+    prev = now;
+    now += rand() % 4 == 0 ? (usec_t)rand() % 1000000 : (usec_t)rand() % 200;
+    n_expired += wheel_advance(&wheel, now, &expired);
+    // never early, never later than the first advance past the expiry, in expiry order
+    usec_t last = 0;
+    while ((timer = LIST_GET_FIRST(expired)) != NULL) {
+      struct conn *conn = CONN(timer);
+      LIST_REMOVE(link, expired, timer);
+      assert(conn->scheduled && conn->expire <= now);
+      assert(conn->expire > prev || conn->round == round);
+      assert(conn->expire >= last || conn->round == round);
+      last = conn->expire;
+      conn->scheduled = false;
+      assert(!wheel_cancel(&wheel, timer));
+    }
+  }
+
+  // a jump far ahead drains the wheel, including timers past its span
+  n_expired += wheel_advance(&wheel, now + ((usec_t)1 << 40), &expired);
+  assert(n_expired == n_scheduled - n_cancelled);
+  assert(wheel_size(&wheel) == 0 && !wheel_next_expire(&wheel, &next));
+  LIST_FOREACH(link, timer, expired) {
+    assert(CONN(timer)->scheduled);
+  }
+  printf("%zu expired, %zu cancelled\n", n_expired, n_cancelled);
+  wheel_destroy(&wheel);
+
+  // real time, workers schedule and cancel while a driver advances
+  wheel_init(&wheel, 1000, usec_now());
+  pthread_create(&threads[N_THREADS], NULL, driver, NULL);
+  for (int i = 0; i < N_THREADS; i++) {
+    pthread_create(&threads[i], NULL, worker, timers[i]);
+  }
+  n_cancelled = 0;
+  for (int i = 0; i < N_THREADS; i++) {
+    void *ret;
+    pthread_join(threads[i], &ret);
+    n_cancelled += (size_t)ret;
+  }
+  while (wheel_size(&wheel) != 0) {
+  }
+  __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+  pthread_join(threads[N_THREADS], NULL);
+  assert(n_fired + n_cancelled == N_THREADS * N_PER_THREAD);
+  wheel_destroy(&wheel);
+
+  printf("wheel test passed\n");
+  return 0;
+}